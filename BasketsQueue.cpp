@@ -0,0 +1,237 @@
+/*
+
+Copyright 2015 University of Rochester
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+
+
+
+
+
+// Baskets queue.
+//
+// See:
+//   M. Hoffman, O. Shalev and N. Shavit. The baskets queue.
+//   OPODIS 2007.
+// 
+
+
+#include <list>
+#include <iostream>
+#include "RContainer.hpp"
+#include "BasketsQueue.hpp"
+
+using namespace std;
+
+BasketsQueue::BasketsQueue(int task_num, bool glibc_mem){
+	this->task_num = task_num;
+	bp = new BlockPool<Node>(task_num,glibc_mem);
+	Node* dummy = bp->alloc(0);
+	dummy->next.store(mptr_local<Node>(false,NULL,1).all());
+	dummy->val = 0;
+	head.init(dummy,0);
+	tail.init(dummy,0);
+
+	stats = new padded<Stats>[task_num];
+	for(int i=0;i<task_num;i++){
+		stats[i].ui.basketed = 0;
+		stats[i].ui.frees = 0;
+	}
+
+	// preheat block pool
+	std::list<Node*> v;
+	for(int i=0;i<task_num;i++){
+		for(int j=0; j<2500; j++){
+			v.push_back(bp->alloc(i));
+		}
+	}
+	for(int i=0;i<task_num;i++){
+		for(int j=0; j<2500; j++){
+			bp->free(v.front(),i);
+			v.pop_front();
+		}
+	}
+}
+
+void BasketsQueue::conclude(){
+	int64_t basketed = 0, frees = 0;
+	for(int i=0;i<task_num;i++){
+		basketed+=stats[i].ui.basketed;
+		frees+=stats[i].ui.frees;
+	}
+	cout<<"basketed="<<basketed<<" frees="<<frees<<endl;
+}
+
+inline bool BasketsQueue::casNext(Node* n, mptr_local<Node>& oldval, mptr_local<Node>& newval){
+	uint64_t old = oldval.all();
+	return n->next.compare_exchange_strong(old,newval.all(),std::memory_order_acq_rel);
+}
+
+// swing a lagging tail to the last node
+void BasketsQueue::fixTail(cptr_local<Node> my_tail, mptr_local<Node> next){
+	mptr_local<Node> after;
+	after.init(next.ptr()->next.load());
+	while(after.ptr()!=NULL && my_tail.all()==tail.all()){
+		next.init(after.all());
+		after.init(next.ptr()->next.load());
+	}
+	tail.CAS(my_tail,next.ptr());
+}
+
+// move head to new_head and free the deleted nodes before it
+void BasketsQueue::freeChain(cptr_local<Node> my_head, Node* new_head, int tid){
+	mptr_local<Node> next;
+	Node* n;
+	if(head.CAS(my_head,new_head)){
+		stats[tid].ui.frees++;
+		n = my_head.ptr();
+		while(n!=new_head){
+			next.init(n->next.load());
+			bp->free(n,tid);
+			n = next.ptr();
+		}
+	}
+}
+
+// Finds the first next word without the deleted bit, whose
+// target is the front of the queue: iter is the node holding
+// it and hops the deleted links walked to get there.  Helps a
+// lagging tail and frees a prefix deleted all the way to tail.
+// Returns false if the queue is empty.
+bool BasketsQueue::findFirst(cptr_local<Node>& my_head, Node*& iter, mptr_local<Node>& next, int& hops, int tid){
+	cptr_local<Node> my_tail;
+	while(true){
+		my_head.init(head);
+		my_tail.init(tail);
+		next.init(my_head->next.load());
+		if(my_head.all()!=head.all()){continue;}
+		if(my_head.ptr()==my_tail.ptr()){
+			if(next.ptr()==NULL){return false;}
+			fixTail(my_tail,next);
+			continue;
+		}
+		iter = my_head.ptr();
+		hops = 0;
+		while(next.marked() && iter!=my_tail.ptr() && my_head.all()==head.all()){
+			iter = next.ptr();
+			next.init(iter->next.load());
+			hops++;
+		}
+		if(my_head.all()!=head.all()){continue;}
+		if(iter==my_tail.ptr()){
+			freeChain(my_head,iter,tid);
+			continue;
+		}
+		return true;
+	}
+}
+
+void BasketsQueue::enqueue(int32_t val, int tid){
+	Node* nd = bp->alloc(tid);
+	cptr_local<Node> my_tail;
+	mptr_local<Node> next;
+	mptr_local<Node> newval;
+	uint32_t tag;
+	nd->val = val;
+	while(true){
+		my_tail.init(tail);
+		next.init(my_tail->next.load());
+		if(my_tail.all()!=tail.all()){continue;}
+		if(next.ptr()!=NULL){
+			fixTail(my_tail,next);
+			continue;
+		}
+		// the tag nd's next will need once nd is tail
+		nd->next.store(mptr_local<Node>(false,NULL,my_tail.sn()+2).all());
+		newval.init(false,nd,my_tail.sn()+1);
+		if(casNext(my_tail.ptr(),next,newval)){
+			tail.CAS(my_tail,nd);
+			return;
+		}
+		// lost to an enqueue that overlapped ours, so go in its
+		// basket, ahead of it, until a dequeue reaches the basket
+		tag = newval.sn();
+		next.init(my_tail->next.load());
+		while(next.sn()==tag && !next.marked()){
+			nd->next.store(next.all());
+			if(casNext(my_tail.ptr(),next,newval)){
+				stats[tid].ui.basketed++;
+				return;
+			}
+			next.init(my_tail->next.load());
+		}
+	}
+}
+
+int32_t BasketsQueue::dequeue(int tid){
+	cptr_local<Node> my_head;
+	mptr_local<Node> next;
+	mptr_local<Node> newval;
+	Node* iter;
+	int hops;
+	int32_t val;
+	while(findFirst(my_head,iter,next,hops,tid)){
+		// Read value out of node before CAS. Otherwise another dequeue
+		// might free the next node.
+		val = next.ptr()->val;
+		newval.init(true,next.ptr(),next.sn()+1);
+		if(casNext(iter,next,newval)){
+			if(hops>=MAX_HOPS){
+				freeChain(my_head,next.ptr(),tid);
+			}
+			return val;
+		}
+	}
+	return EMPTY;
+}
+
+KeyVal BasketsQueue::peek(int tid){
+	cptr_local<Node> my_head;
+	mptr_local<Node> next;
+	Node* iter;
+	int hops;
+	KeyVal kv;
+	while(findFirst(my_head,iter,next,hops,tid)){
+		kv.val = next.ptr()->val;
+		kv.key = next.all();
+		// verify snapshot
+		if(iter->next.load()==next.all()){
+			return kv;
+		}
+	}
+	kv.key = 0;
+	kv.val = EMPTY;
+	return kv;
+}
+
+bool BasketsQueue::remove_cond(uint64_t key, int tid){
+	cptr_local<Node> my_head;
+	mptr_local<Node> next;
+	mptr_local<Node> newval;
+	Node* iter;
+	int hops;
+	if(!findFirst(my_head,iter,next,hops,tid) || next.all()!=key){
+		return false;
+	}
+	newval.init(true,next.ptr(),next.sn()+1);
+	if(!casNext(iter,next,newval)){
+		return false;
+	}
+	if(hops>=MAX_HOPS){
+		freeChain(my_head,next.ptr(),tid);
+	}
+	return true;
+}
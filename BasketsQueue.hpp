@@ -0,0 +1,103 @@
+/*
+
+Copyright 2015 University of Rochester
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+
+
+
+
+
+// Baskets queue.
+//
+// See:
+//   M. Hoffman, O. Shalev and N. Shavit. The baskets queue.
+//   OPODIS 2007.
+//
+// An MSQueue whose enqueuers, on losing the CAS at the end of
+// the list, don't start over from tail: everyone who lost to
+// the same winner overlapped with it, so they may go in any
+// order and push themselves in just after the old tail instead.
+// Those nodes form a basket, told by the tag the winner left in
+// the old tail's next word.  Dequeues only set a deleted bit in
+// the predecessor's next word; head is swung past the deleted
+// prefix once a dequeuer walks MAX_HOPS of it, or the prefix
+// reaches tail, and the nodes are freed then.
+//
+// Next words are mptr_local's layout (deleted bit, tag, pointer)
+// in a plain atomic, since basket inserts need to CAS in a tag
+// that isn't the old one plus one.  As in MSQueue, freed nodes
+// go straight back to the BlockPool and may still be read.
+// peek()'s key is the first undeleted next word, so remove_cond()
+// fails if that node is gone or a basket insert got ahead of it.
+
+
+#ifndef BASKETS_QUEUE_H
+#define BASKETS_QUEUE_H
+
+#include <atomic>
+#include "RDualContainer.hpp"
+#include "BlockPool.hpp"
+#include "MichaelOrderedSet.hpp"
+
+class BasketsQueue : public virtual RPeekableContainer, public virtual RQueue, public Reportable{
+
+	static const int MAX_HOPS = 3;
+
+	class Node{
+	public:
+		std::atomic<uint64_t> next; // an mptr_local<Node>
+		int32_t val;
+	};
+
+	cptr<Node> head
+	__attribute__(( aligned(CACHE_LINE_SIZE) )); uint8_t pad1[CACHE_LINE_SIZE-sizeof(cptr<Node>)]; // pad
+	cptr<Node> tail
+	__attribute__(( aligned(CACHE_LINE_SIZE) )); uint8_t pad2[CACHE_LINE_SIZE-sizeof(cptr<Node>)]; // pad
+
+	BlockPool<Node>* bp;
+	int task_num;
+	struct Stats{
+		int64_t basketed; // enqueues that went in a basket
+		int64_t frees; // head swings
+	};
+	padded<Stats>* stats;
+
+	bool casNext(Node* n, mptr_local<Node>& oldval, mptr_local<Node>& newval);
+	void fixTail(cptr_local<Node> my_tail, mptr_local<Node> next);
+	void freeChain(cptr_local<Node> my_head, Node* new_head, int tid);
+	bool findFirst(cptr_local<Node>& my_head, Node*& iter, mptr_local<Node>& next, int& hops, int tid);
+
+public:
+	BasketsQueue(int task_num, bool glibc_mem);
+
+	void conclude();
+
+	void enqueue(int32_t val,int tid);
+	int32_t dequeue(int tid);
+	void insert(int32_t val,int tid){return enqueue(val,tid);}
+	int32_t remove(int tid){return dequeue(tid);}
+	KeyVal peek(int tid);
+	bool remove_cond(uint64_t key, int tid);
+};
+
+class BasketsQueueFactory : public RContainerFactory{
+	BasketsQueue* build(GlobalTestConfig* gtc){
+		return new BasketsQueue(gtc->task_num,gtc->environment["glibc"]=="1");
+	}
+};
+
+#endif
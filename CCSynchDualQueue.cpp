@@ -0,0 +1,207 @@
+/*
+
+Copyright 2015 University of Rochester
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+
+
+#include "CCSynchDualQueue.hpp"
+#include <iostream>
+
+using namespace std;
+
+CCSynchDualQueue::CCSynchDualQueue(int task_num, int clusters, int budget){
+	if(clusters<1){clusters = 1;}
+	if(clusters>task_num){clusters = task_num;}
+	this->task_num = task_num;
+	this->num_clusters = clusters;
+	this->cluster_size = (task_num+clusters-1)/clusters;
+	this->budget = budget<1?1:budget;
+	global_lock.store(false);
+
+	this->clusters = new padded<Cluster>[clusters];
+	for(int i = 0; i<clusters; i++){
+		// the first to swap in finds this node free and combines
+		Node* dummy = newNode();
+		dummy->wait.store(false);
+		this->clusters[i].ui.tail.store(dummy);
+	}
+	my_nodes = new padded<Node*>[task_num];
+	reservations = new padded<Reservation>[task_num];
+	for(int i = 0; i<task_num; i++){
+		my_nodes[i].ui = newNode();
+		reservations[i].ui.filled.store(false);
+		reservations[i].ui.item = NULL_VAL;
+	}
+	#ifdef FC_STATS
+	stats = new padded<CombineStats>[task_num];
+	for(int i = 0; i<task_num; i++){
+		stats[i].ui.passes = 0;
+		stats[i].ui.served = 0;
+	}
+	#endif
+}
+
+CCSynchDualQueue::~CCSynchDualQueue(){
+	// one node per thread plus one per cluster, wherever they are now
+	for(int i = 0; i<task_num; i++){
+		free(my_nodes[i].ui);
+	}
+	for(int i = 0; i<num_clusters; i++){
+		free(clusters[i].ui.tail.load());
+	}
+	delete[] my_nodes;
+	delete[] clusters;
+	delete[] reservations;
+	#ifdef FC_STATS
+	delete[] stats;
+	#endif
+}
+
+CCSynchDualQueue::Node* CCSynchDualQueue::newNode(){
+	Node* n;
+	if(posix_memalign((void**)&n,LEVEL1_DCACHE_LINESIZE,
+	  ((sizeof(Node)-1)/LEVEL1_DCACHE_LINESIZE+1)*LEVEL1_DCACHE_LINESIZE)!=0){
+		errexit("CCSynchDualQueue node allocation failed.");
+	}
+	n->item = NULL_VAL;
+	n->consumer = false;
+	n->tid = -1;
+	n->reserved = false;
+	n->wait.store(true);
+	n->completed = false;
+	n->next.store(NULL);
+	return n;
+}
+
+void CCSynchDualQueue::lockGlobal(){
+	while(true){
+		if(!global_lock.load(std::memory_order_relaxed)
+		  && !global_lock.exchange(true,std::memory_order_acquire)){
+			return;
+		}
+	}
+}
+
+void CCSynchDualQueue::unlockGlobal(){
+	global_lock.store(false,std::memory_order_release);
+}
+
+// sequential dual queue step, combiner only
+void CCSynchDualQueue::apply(Node* n){
+	if(!n->consumer){
+		if(!waiters.empty()){
+			// oldest reservation first
+			Reservation* r = &(reservations[waiters.front()].ui);
+			waiters.pop_front();
+			r->item = n->item;
+			r->filled.store(true,std::memory_order_release);
+		}
+		else{
+			items.push_back(n->item);
+		}
+	}
+	else{
+		if(!items.empty()){
+			n->item = items.front();
+			items.pop_front();
+			n->reserved = false;
+		}
+		else{
+			waiters.push_back(n->tid);
+			n->reserved = true;
+		}
+	}
+}
+
+CCSynchDualQueue::Node* CCSynchDualQueue::combine(bool consumer, int32_t item, int tid){
+	Cluster* c = &(clusters[num_clusters==1?0:tid/cluster_size].ui);
+
+	// our spare node becomes the new tail, and the
+	// old tail carries our request
+	Node* next_node = my_nodes[tid].ui;
+	next_node->next.store(NULL,std::memory_order_relaxed);
+	next_node->wait.store(true,std::memory_order_relaxed);
+	next_node->completed = false;
+	Node* cur_node = c->tail.exchange(next_node);
+	cur_node->item = item;
+	cur_node->consumer = consumer;
+	cur_node->tid = tid;
+	cur_node->next.store(next_node,std::memory_order_release);
+	my_nodes[tid].ui = cur_node;
+
+	while(cur_node->wait.load(std::memory_order_acquire)){}
+	if(cur_node->completed){
+		return cur_node;
+	}
+
+	// we are the combiner for our list
+	if(num_clusters>1){
+		lockGlobal();
+	}
+	Node* tmp = cur_node;
+	Node* tmp_next;
+	int served = 0;
+	while((tmp_next = tmp->next.load(std::memory_order_acquire))!=NULL && served<budget){
+		apply(tmp);
+		tmp->completed = true;
+		tmp->wait.store(false,std::memory_order_release);
+		tmp = tmp_next;
+		served++;
+	}
+	if(num_clusters>1){
+		unlockGlobal();
+	}
+	#ifdef FC_STATS
+	stats[tid].ui.passes++;
+	stats[tid].ui.served+=served;
+	#endif
+	// tmp's owner combines next, or the next arrival does
+	tmp->wait.store(false,std::memory_order_release);
+	return cur_node;
+}
+
+void CCSynchDualQueue::insert(int32_t val, int tid){
+	combine(false,val,tid);
+}
+
+int32_t CCSynchDualQueue::remove(int tid){
+	Node* n = combine(true,NULL_VAL,tid);
+	if(!n->reserved){
+		return n->item;
+	}
+	Reservation* r = &(reservations[tid].ui);
+	while(!r->filled.load(std::memory_order_acquire)){}
+	r->filled.store(false,std::memory_order_relaxed);
+	return r->item;
+}
+
+void CCSynchDualQueue::conclude(){
+	if(num_clusters>1){
+		std::cout<<"clusters="<<num_clusters<<" ";
+	}
+	std::cout<<"combine_budget="<<budget;
+	#ifdef FC_STATS
+	uint64_t passes = 0, served = 0;
+	for(int i = 0; i<task_num; i++){
+		passes+=stats[i].ui.passes;
+		served+=stats[i].ui.served;
+	}
+	std::cout<<" combining_passes="<<passes
+	  <<" requests_per_pass="<<(passes?(double)served/passes:0);
+	#endif
+	std::cout<<std::endl;
+}
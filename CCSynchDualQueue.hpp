@@ -0,0 +1,141 @@
+/*
+
+Copyright 2015 University of Rochester
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+
+
+#ifndef CCSYNCH_DUALQUEUE_HPP
+#define CCSYNCH_DUALQUEUE_HPP
+
+#ifndef _REENTRANT
+#define _REENTRANT		/* basic 3-lines for threads */
+#endif
+
+#include <stdint.h>
+#include <atomic>
+#include <string>
+#include "ConcurrentPrimitives.hpp"
+#include "RDualContainer.hpp"
+#include "GrowRing.hpp"
+
+
+// Combining dual queue on
+// "Revisiting the Combining Synchronization Technique"
+// Panagiota Fatourou and Nikolaos Kallimanis
+// 2012
+//
+// CC-Synch: a thread announces its request by swapping a fresh
+// node onto the tail of a list and spins on its own node.  The
+// thread whose node reaches the head combines: it serves up to
+// budget requests down the list, then clears the wait flag of
+// the next node, handing the combiner role to that node's owner.
+// Nobody polls a lock, and each combiner pass is bounded.
+//
+// H-Synch: threads are split into clusters (sockets), each with
+// its own CC-Synch list.  A cluster's combiner additionally takes
+// a global lock, so requests are combined per cluster and the
+// lock moves between clusters once per pass.
+//
+// The sequential queue behind the combiner is a dual queue: it
+// holds either items or waiting consumers.  A consumer that finds
+// no item is left as a reservation; its node is released as
+// usual, and it spins on its own reservation until a later
+// producer fills it.
+
+class CCSynchDualQueue : public virtual RDualContainer, public Reportable{
+
+	struct Node{
+		int32_t item;
+		bool consumer;
+		int tid;
+		bool reserved; // completed as a reservation
+		std::atomic<bool> wait;
+		bool completed;
+		std::atomic<Node*> next;
+	};
+
+	struct Reservation{
+		std::atomic<bool> filled;
+		int32_t item;
+	};
+
+	struct Cluster{
+		std::atomic<Node*> tail;
+	};
+
+	// combiner state
+	GrowRing<int32_t> items;
+	GrowRing<int> waiters; // tids of reservations, oldest first
+	char pad1[LEVEL1_DCACHE_LINESIZE];
+
+	// H-Synch only
+	std::atomic<bool> global_lock;
+	char pad2[LEVEL1_DCACHE_LINESIZE-sizeof(std::atomic<bool>)];
+
+	padded<Cluster>* clusters;
+	padded<Node*>* my_nodes;
+	padded<Reservation>* reservations;
+	int task_num;
+	int num_clusters;
+	int cluster_size;
+	int budget; // requests served per combiner pass
+
+	#ifdef FC_STATS
+	struct CombineStats{
+		uint64_t passes;
+		uint64_t served;
+	};
+	padded<CombineStats>* stats;
+	#endif
+
+	Node* newNode();
+	void apply(Node* n);
+	void lockGlobal();
+	void unlockGlobal();
+	// announce a request, returns the served node
+	Node* combine(bool consumer, int32_t item, int tid);
+
+public:
+	// clusters==1 is CC-Synch, more is H-Synch
+	CCSynchDualQueue(int task_num, int clusters, int budget);
+	~CCSynchDualQueue();
+
+	void insert(int32_t val, int tid);
+	int32_t remove(int tid);
+
+	void conclude();
+};
+
+// H-Synch takes the cluster count from -dclusters=N (default 2);
+// the budget from -dcombine_budget=N (default 3 x threads)
+class CCSynchDualQueueFactory : public RContainerFactory{
+	bool hierarchical;
+public:
+	CCSynchDualQueueFactory(bool hierarchical){this->hierarchical = hierarchical;}
+	CCSynchDualQueue* build(GlobalTestConfig* gtc){
+		int clusters = 1;
+		if(hierarchical){
+			std::string c = gtc->environment["clusters"];
+			clusters = c.empty()?2:atoi(c.c_str());
+		}
+		std::string b = gtc->environment["combine_budget"];
+		int budget = b.empty()?3*gtc->task_num:atoi(b.c_str());
+		return new CCSynchDualQueue(gtc->task_num,clusters,budget);
+	}
+};
+
+#endif
@@ -0,0 +1,205 @@
+/*
+
+Copyright 2015 University of Rochester
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+
+
+
+
+// Many waiters on few threads.
+// waiters consumers each remove count/waiters values from a
+// GenericDual that producers insert into.  In blocking mode
+// every consumer is a thread spinning in remove(), as the
+// harness tests run them; in coro mode each is a coroutine
+// parked on the queue with co_await, and everything runs as
+// tasks on an Executor of threads workers.
+//
+// usage: coawait <blocking|coro> [waiters] [threads] [count]
+
+#ifndef _REENTRANT
+#define _REENTRANT		/* basic 3-lines for threads */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sys/time.h>
+#include <atomic>
+#include "GenericDual.hpp"
+#include "MSQueue.hpp"
+#include "Executor.hpp"
+#include "DualAwait.hpp"
+
+using namespace std;
+
+#if !defined(__cpp_impl_coroutine)
+#error coawait needs a compiler with C++20 coroutines
+#endif
+
+static double now(){
+	struct timeval tv;
+	gettimeofday(&tv,NULL);
+	return tv.tv_sec + tv.tv_usec/1000000.0;
+}
+
+static GenericDual* dq;
+static int waiters;
+static int threads;
+static int32_t per; // values per waiter
+static std::atomic<int64_t> removedSum;
+static std::atomic<int> remaining; // consumers still running
+
+// producer p inserts the values in 1..total congruent to p+1
+static void produce(int p, int tid){
+	int32_t total = per*waiters;
+	for(int32_t v = p+1; v<=total; v+=threads){
+		dq->insert(v,tid);
+	}
+}
+
+// blocking mode
+
+static void* blockingConsumer(void* a){
+	int tid = (int)(intptr_t)a;
+	int64_t sum = 0;
+	for(int32_t i = 0; i<per; i++){
+		sum+=dq->remove(tid);
+	}
+	removedSum.fetch_add(sum);
+	return NULL;
+}
+
+static void* blockingProducer(void* a){
+	int tid = (int)(intptr_t)a;
+	produce(tid-waiters,tid);
+	return NULL;
+}
+
+static void runBlocking(){
+	pthread_attr_t attr;
+	pthread_attr_init(&attr);
+	pthread_attr_setstacksize(&attr,64*1024); // thousands of threads in 32 bits
+	int n = waiters+threads;
+	pthread_t* ts = new pthread_t[n];
+	for(int i = 0; i<n; i++){
+		if(pthread_create(&ts[i],&attr,i<waiters?blockingConsumer:blockingProducer,(void*)(intptr_t)i)!=0){
+			errexit("pthread_create failed\n");
+		}
+	}
+	for(int i = 0; i<n; i++){
+		pthread_join(ts[i],NULL);
+	}
+	delete[] ts;
+}
+
+// coro mode
+
+static Executor* ex;
+
+static DualTask coroConsumer(int tid){
+	co_await OnExecutor(ex,tid);
+	int64_t sum = 0;
+	for(int32_t i = 0; i<per; i++){
+		sum+=co_await DualRemove(dq,ex,tid);
+	}
+	removedSum.fetch_add(sum);
+	if(remaining.fetch_sub(1)==1){
+		ex->stop(tid);
+	}
+}
+
+static DualTask coroProducer(int p, int tid){
+	co_await OnExecutor(ex,tid);
+	produce(p,tid); // woken consumers queue up on this worker to be stolen
+}
+
+static void* worker(void* a){
+	ex->run((int)(intptr_t)a);
+	return NULL;
+}
+
+static void runCoro(){
+	ex = new Executor(new GenericDual(new MSQueue(threads,false),new MSQueue(threads,false),false,threads,false),threads,false);
+	remaining.store(waiters);
+	// started from here as worker 0, before any worker runs
+	for(int i = 0; i<waiters; i++){
+		coroConsumer(0);
+	}
+	for(int p = 0; p<threads; p++){
+		coroProducer(p,0);
+	}
+	pthread_t* ts = new pthread_t[threads];
+	for(int i = 0; i<threads; i++){
+		pthread_create(&ts[i],NULL,worker,(void*)(intptr_t)i);
+	}
+	int64_t steals = 0;
+	for(int i = 0; i<threads; i++){
+		pthread_join(ts[i],NULL);
+		steals+=ex->steals(i);
+	}
+	printf("executor steals=%lld\n",(long long)steals);
+	delete[] ts;
+}
+
+int main(int argc, char *argv[]){
+
+	if(argc<2){
+		fprintf(stderr,"usage: %s <blocking|coro> [waiters] [threads] [count]\n",argv[0]);
+		return -1;
+	}
+	const char* mode = argv[1];
+	waiters = 1024;
+	threads = 4;
+	int32_t count = 1000000;
+	if(argc>2){waiters = atoi(argv[2]);}
+	if(argc>3){threads = atoi(argv[3]);}
+	if(argc>4){count = atoi(argv[4]);}
+	per = count/waiters;
+	if(waiters<1 || threads<1 || per<1){
+		fprintf(stderr,"need count >= waiters >= 1, threads >= 1\n");
+		return -1;
+	}
+	removedSum.store(0);
+
+	bool coro = strcmp(mode,"coro")==0;
+	if(!coro && strcmp(mode,"blocking")!=0){
+		fprintf(stderr,"unknown mode %s\n",mode);
+		return -1;
+	}
+	int task_num = coro?threads:waiters+threads;
+	dq = new GenericDual(new MSQueue(task_num,false),new MSQueue(task_num,false),false,task_num,false);
+
+	double start = now();
+	if(coro){
+		runCoro();
+	}
+	else{
+		runBlocking();
+	}
+	double t = now()-start;
+
+	int64_t total = (int64_t)per*waiters;
+	int64_t sum = total*(total+1)/2;
+	if(sum!=removedSum.load()){
+		fprintf(stderr,"inserted sum %lld but removed %lld\n",(long long)sum,(long long)removedSum.load());
+		return -1;
+	}
+	printf("%s waiters=%d threads=%d values=%d time=%f ops/sec=%f\n",
+	  mode,waiters,threads,per*waiters,t,per*waiters/t);
+	return 0;
+}
@@ -0,0 +1,133 @@
+/*
+
+Copyright 2015 University of Rochester
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+
+
+
+
+#ifndef DUAL_AWAIT_HPP
+#define DUAL_AWAIT_HPP
+
+// C++20 coroutine front end for the dual containers.
+//
+// co_await DualRemove(dq,ex,tid) removes from an
+// RAsyncDualContainer without holding a thread: if nothing
+// is there, the awaiter itself is published as the remove's
+// DualWaiter in place of the spin target, and the insert
+// that satisfies it schedules the coroutine back onto ex as
+// a task.  So many logical waiters share a few workers.
+//
+// The coroutine's tid is a variable in its own frame, passed
+// by reference to each awaitable, and rewritten to the tid
+// of whichever worker resumes it.  Coroutines start and
+// yield with co_await OnExecutor(ex,tid).
+//
+// Everything else builds as C++0x, so this is only
+// compiled where coroutines are available.
+
+#if defined(__cpp_impl_coroutine)
+
+#include <coroutine>
+#include <stdlib.h>
+#include "RDualContainer.hpp"
+#include "Executor.hpp"
+
+// fire and forget coroutine; it runs eagerly up to
+// its first co_await and frees its frame on return
+struct DualTask{
+	struct promise_type{
+		DualTask get_return_object(){return DualTask();}
+		std::suspend_never initial_suspend() noexcept{return {};}
+		std::suspend_never final_suspend() noexcept{return {};}
+		void return_void(){}
+		void unhandled_exception(){abort();}
+	};
+};
+
+// resumes a suspended coroutine from an executor task
+class ExecutorResume{
+protected:
+	Executor* ex;
+	int* tid;
+	std::coroutine_handle<> h;
+
+	static void run(Executor* ex, Task* t, int tid){
+		ExecutorResume* r = (ExecutorResume*)t->ctx;
+		*r->tid = tid;
+		r->h.resume();
+	}
+
+	// after this the coroutine may run, and finish, anywhere
+	void schedule(int tid){
+		Task* t = ex->newTask(run,NULL,tid);
+		t->ctx = this;
+		ex->spawn(t,tid);
+	}
+
+public:
+	ExecutorResume(Executor* ex, int& tid){
+		this->ex = ex;
+		this->tid = &tid;
+	}
+};
+
+// reschedules the coroutine onto ex: to start it on a
+// worker, or to yield that worker to other tasks
+class OnExecutor : public ExecutorResume{
+public:
+	OnExecutor(Executor* ex, int& tid) : ExecutorResume(ex,tid){}
+	bool await_ready(){return false;}
+	void await_suspend(std::coroutine_handle<> h){
+		this->h = h;
+		schedule(*tid);
+	}
+	void await_resume(){}
+};
+
+class DualRemove : public ExecutorResume, public DualWaiter{
+	RAsyncDualContainer* dq;
+	int32_t val;
+
+public:
+	DualRemove(RAsyncDualContainer* dq, Executor* ex, int& tid) : ExecutorResume(ex,tid){
+		this->dq = dq;
+		val = EMPTY;
+	}
+	bool await_ready(){return false;}
+	bool await_suspend(std::coroutine_handle<> h){
+		this->h = h;
+		// once parked we may be woken, resumed and destroyed
+		// before removeAsync returns, so use only the local
+		int32_t v = dq->removeAsync(this,*tid);
+		if(v==EMPTY){
+			return true;
+		}
+		val = v;
+		return false; // completed at once, carry on
+	}
+	int32_t await_resume(){return val;}
+
+	void wake(int32_t val, int tid){
+		this->val = val;
+		schedule(tid);
+	}
+};
+
+#endif
+
+#endif
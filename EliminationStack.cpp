@@ -0,0 +1,217 @@
+/*
+
+Copyright 2015 University of Rochester
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+
+
+// Elimination backoff stack.
+//
+// See:
+//   D. Hendler, N. Shavit and L. Yerushalmi. A scalable lock-free
+//   stack algorithm. SPAA 2004.
+// 
+
+
+#include <iostream>
+#include "RContainer.hpp"
+#include "EliminationStack.hpp"
+
+using namespace std;
+
+EliminationStack::EliminationStack(int task_num, bool glibc_mem){
+	top.init(NULL,0);
+	bp = new BlockPool<Node>(task_num,glibc_mem);
+	this->task_num = task_num;
+
+	num_slots = task_num/2>0?task_num/2:1;
+	slots = new padded<std::atomic<uint64_t>>[num_slots];
+	for(int i = 0; i<num_slots; i++){
+		slots[i].ui.store(slotWord(SLOT_FREE,0,0));
+	}
+	ts = new padded<ThreadState>[task_num];
+	for(int i = 0; i<task_num; i++){
+		ts[i].ui.seed = i+1;
+		ts[i].ui.range = num_slots;
+		ts[i].ui.eliminated = 0;
+	}
+}
+
+void EliminationStack::conclude(){
+	int64_t eliminated = 0;
+	for(int i = 0; i<task_num; i++){
+		eliminated+=ts[i].ui.eliminated;
+	}
+	cout<<"eliminated="<<eliminated<<endl;
+	int i = 0;
+	while(this->remove(0)!=EMPTY){
+		i++;
+	}
+	cout<<"size@End="<<i<<endl;
+}
+
+int EliminationStack::pickSlot(int tid){
+	uint32_t x = ts[tid].ui.seed;
+	x ^= x<<13;
+	x ^= x>>17;
+	x ^= x<<5;
+	ts[tid].ui.seed = x;
+	return x%ts[tid].ui.range;
+}
+
+// true if a pop took val
+bool EliminationStack::eliminatePush(int32_t val, int tid){
+	ThreadState* me = &(ts[tid].ui);
+	std::atomic<uint64_t>* slot = &(slots[pickSlot(tid)].ui);
+	uint64_t w = slot->load();
+
+	if(slotState(w)==SLOT_POP_WAIT){
+		// a pop is waiting, hand it val
+		if(slot->compare_exchange_strong(w,slotWord(SLOT_DONE,slotTag(w),val))){
+			me->eliminated++;
+			return true;
+		}
+	}
+	else if(slotState(w)==SLOT_FREE){
+		uint64_t mine = slotWord(SLOT_PUSH_WAIT,slotTag(w),val);
+		if(slot->compare_exchange_strong(w,mine)){
+			for(int i = 0; i<ELIMINATION_SPINS; i++){
+				if(slot->load()!=mine){break;}
+			}
+			// nobody came, withdraw the offer
+			w = mine;
+			if(slot->compare_exchange_strong(w,slotWord(SLOT_FREE,slotTag(mine)+1,0))){
+				if(me->range>1){me->range/=2;}
+				return false;
+			}
+			// a pop took it; we free the slot
+			assert(slotState(w)==SLOT_DONE);
+			slot->store(slotWord(SLOT_FREE,slotTag(mine)+1,0));
+			me->eliminated++;
+			return true;
+		}
+	}
+	// slot busy with another push or an exchange
+	if(me->range<num_slots){me->range++;}
+	return false;
+}
+
+// the value a push gave us, or EMPTY
+int32_t EliminationStack::eliminatePop(int tid){
+	ThreadState* me = &(ts[tid].ui);
+	std::atomic<uint64_t>* slot = &(slots[pickSlot(tid)].ui);
+	uint64_t w = slot->load();
+
+	if(slotState(w)==SLOT_PUSH_WAIT){
+		// a push is waiting, take its value
+		if(slot->compare_exchange_strong(w,slotWord(SLOT_DONE,slotTag(w),0))){
+			me->eliminated++;
+			return slotVal(w);
+		}
+	}
+	else if(slotState(w)==SLOT_FREE){
+		uint64_t mine = slotWord(SLOT_POP_WAIT,slotTag(w),0);
+		if(slot->compare_exchange_strong(w,mine)){
+			for(int i = 0; i<ELIMINATION_SPINS; i++){
+				if(slot->load()!=mine){break;}
+			}
+			w = mine;
+			if(slot->compare_exchange_strong(w,slotWord(SLOT_FREE,slotTag(mine)+1,0))){
+				if(me->range>1){me->range/=2;}
+				return EMPTY;
+			}
+			// a push filled it; we free the slot
+			assert(slotState(w)==SLOT_DONE);
+			slot->store(slotWord(SLOT_FREE,slotTag(mine)+1,0));
+			me->eliminated++;
+			return slotVal(w);
+		}
+	}
+	if(me->range<num_slots){me->range++;}
+	return EMPTY;
+}
+
+void EliminationStack::push(int32_t val,int tid) {
+	Node* newNode;
+	cptr_local<Node> topCopy; 
+	newNode = bp->alloc(tid);
+	newNode->init(val,NULL);
+	while(true) {
+		topCopy.init(top.all()); // read top pointer
+		newNode->down = topCopy.ptr();
+		if(top.CAS(topCopy,newNode)){// swing top
+			return; // finished if succeed
+		}
+		// contended, try to meet a pop instead
+		if(eliminatePush(val,tid)){
+			bp->free(newNode,tid);
+			return;
+		}
+	}
+}
+
+int32_t EliminationStack::pop(int tid) {
+	cptr_local<Node> topCopy;
+	Node* newTop;
+	int32_t val;
+
+	while(true){
+		topCopy.init(top.all()); // read top pointer
+		if (topCopy.ptr()==NULL) { // check if empty
+			return EMPTY;
+		} 
+		newTop = topCopy->down; // get new top
+		if(top.CAS(topCopy,newTop)){// swing top
+			val = topCopy->val;
+			bp->free(topCopy.ptr(),tid);
+			return val; // finished if succeed
+		}
+		// contended, try to meet a push instead
+		val = eliminatePop(tid);
+		if(val!=EMPTY){
+			return val;
+		}
+	}
+}
+
+KeyVal EliminationStack::peek(int tid){
+	cptr_local<Node> topCopy;
+	KeyVal kv;
+	do{
+		topCopy.init(top.all()); // read top pointer
+		kv.key = topCopy.all();
+		if(topCopy.ptr()!=NULL){kv.val = topCopy->val;}
+		else{kv.val=EMPTY;}
+	}while(kv.key!=top.all());
+	return kv;
+}
+
+// removes the top seen by peek; never eliminates, since the
+// caller has to take that particular node
+bool EliminationStack::remove_cond(uint64_t key, int tid){
+	cptr_local<Node> topCopy;
+	Node* newTop;
+	topCopy.init(key);
+	if(topCopy.all()!=top.all()){return false;} // precheck for failure
+	assert(topCopy.ptr()!=NULL);
+
+	newTop = topCopy->down; // get new top
+	if(top.CAS(topCopy,newTop)){// swing top
+		bp->free(topCopy.ptr(),tid);
+		return true; // finished if succeed
+	}
+	return false;
+}
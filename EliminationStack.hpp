@@ -0,0 +1,105 @@
+/*
+
+Copyright 2015 University of Rochester
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+
+
+// Elimination backoff stack.
+//
+// See:
+//   D. Hendler, N. Shavit and L. Yerushalmi. A scalable lock-free
+//   stack algorithm. SPAA 2004.
+//
+// A Treiber stack whose push and pop, after a failed CAS on top,
+// back off into an elimination array instead of retrying at once.
+// A push and a pop that meet in the same slot exchange the value
+// and never touch top.  The array has a slot per two threads, and
+// each thread adapts the range it picks slots from: it shrinks
+// after a wait that met nobody and grows after finding a slot busy.
+
+
+#ifndef ELIMINATION_STACK_H
+#define ELIMINATION_STACK_H
+
+#include "RDualContainer.hpp"
+#include "BlockPool.hpp"
+
+class EliminationStack : public virtual RPeekableContainer, public virtual RStack, public Reportable{
+
+	class Node {
+		public:
+		Node* down;
+		int32_t val;
+		void init(int32_t v, Node* d){down=d;val=v;}
+	};
+
+	// slot word: state in the top 2 bits, a tag bumped each time
+	// the slot is freed in the next 30, the value in the low 32
+	static const uint64_t SLOT_FREE = 0;
+	static const uint64_t SLOT_PUSH_WAIT = 1;
+	static const uint64_t SLOT_POP_WAIT = 2;
+	static const uint64_t SLOT_DONE = 3;
+	static inline uint64_t slotState(uint64_t w){return w>>62;}
+	static inline uint64_t slotTag(uint64_t w){return (w>>32)&0x3fffffff;}
+	static inline int32_t slotVal(uint64_t w){return (int32_t)(w&0xffffffff);}
+	static inline uint64_t slotWord(uint64_t state, uint64_t tag, int32_t val){
+		return (state<<62)|((tag&0x3fffffff)<<32)|(uint32_t)val;
+	}
+
+	struct ThreadState{
+		uint32_t seed;
+		int range;
+		int64_t eliminated;
+	};
+
+	cptr<Node> top
+ 	__attribute__(( aligned(CACHE_LINE_SIZE) )); uint8_t pad1[CACHE_LINE_SIZE-sizeof(cptr<Node>)]; //pad
+
+	padded<std::atomic<uint64_t>>* slots;
+	int num_slots;
+	padded<ThreadState>* ts;
+	BlockPool<Node>* bp;
+	int task_num;
+
+	// spins a thread waits in a slot for a partner
+	const int ELIMINATION_SPINS = 128;
+
+	int pickSlot(int tid);
+	bool eliminatePush(int32_t val, int tid);
+	int32_t eliminatePop(int tid);
+
+	public:
+	EliminationStack(int task_num, bool glibc_mem);
+
+	void conclude();
+
+	void push(int32_t e,int tid);
+	int32_t pop(int tid);
+	void insert(int32_t e,int tid){return push(e,tid);}
+	int32_t remove(int tid){return pop(tid);}
+	KeyVal peek(int tid);
+	bool remove_cond(uint64_t key, int tid);
+
+};
+
+class EliminationStackFactory : public RContainerFactory{
+	EliminationStack* build(GlobalTestConfig* gtc){
+		return new EliminationStack(gtc->task_num,gtc->environment["glibc"]=="1");
+	}
+};
+
+#endif
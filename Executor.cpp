@@ -0,0 +1,157 @@
+/*
+
+Copyright 2015 University of Rochester
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+
+
+#include "Executor.hpp"
+#include <time.h>
+
+Executor::Executor(RContainer* ready, int workers, bool glibc_mem){
+	this->ready = ready;
+	this->dual = dynamic_cast<RDualContainer*>(ready)!=NULL;
+	this->workers = workers;
+	deques = new padded<WSDeque<Task>>[workers];
+	stats = new padded<Stats>[workers];
+	for(int i = 0; i<workers; i++){
+		stats[i].ui.tasks = 0;
+		stats[i].ui.steals = 0;
+		stats[i].ui.wakes = 0;
+		stats[i].ui.wakeNs = 0;
+	}
+	bp = new BlockPool<Task>(workers,glibc_mem);
+	idle.store(0);
+	handoffs.store(0);
+	stopping.store(false);
+}
+
+Executor::~Executor(){
+	delete[] deques;
+	delete[] stats;
+	delete bp;
+}
+
+uint64_t Executor::nowNs(){
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC,&ts);
+	return (uint64_t)ts.tv_sec*1000000000ULL+ts.tv_nsec;
+}
+
+Task* Executor::newTask(TaskFn fn, Task* parent, int tid){
+	Task* t = bp->alloc(tid);
+	t->fn = fn;
+	t->parent = parent;
+	t->join.store(0,std::memory_order_relaxed);
+	t->forked = false;
+	t->in = 0;
+	t->out = 0;
+	t->ctx = parent!=NULL?parent->ctx:NULL;
+	t->stamp = 0;
+	return t;
+}
+
+void Executor::spawn(Task* t, int tid){
+	// hand it to a waiting worker, unless enough are already
+	// on their way; otherwise keep it local for stealing
+	if(idle.load(std::memory_order_relaxed)>handoffs.load(std::memory_order_relaxed)
+	  || !deques[tid].ui.push(t)){
+		t->stamp = nowNs();
+		handoffs.fetch_add(1);
+		ready->insert((int32_t)(intptr_t)t,tid);
+	}
+}
+
+void Executor::continueWith(Task* t, TaskFn cont, int n){
+	t->fn = cont;
+	t->forked = true;
+	// the extra count is dropped when the forking fn returns,
+	// so children finishing early can't rerun t beneath it
+	t->join.store(n+1,std::memory_order_relaxed);
+}
+
+void Executor::execute(Task* t, int tid){
+	while(t!=NULL){
+		t->forked = false;
+		t->fn(this,t,tid);
+		stats[tid].ui.tasks++;
+		if(t->forked){
+			if(t->join.fetch_sub(1)!=1){
+				return; // last child will resume it
+			}
+			continue; // children already done, run the continuation
+		}
+		Task* p = t->parent;
+		bp->free(t,tid);
+		t = NULL;
+		if(p!=NULL && p->join.fetch_sub(1)==1){
+			t = p; // we finished the last child, resume the parent here
+		}
+	}
+}
+
+Task* Executor::steal(int tid){
+	for(int i = 1; i<workers; i++){
+		Task* t = deques[(tid+i)%workers].ui.steal();
+		if(t!=NULL){
+			stats[tid].ui.steals++;
+			return t;
+		}
+	}
+	return NULL;
+}
+
+void Executor::run(int tid){
+	int32_t v;
+	Task* t;
+	while(!stopping.load(std::memory_order_relaxed)){
+		t = deques[tid].ui.pop();
+		if(t==NULL){
+			t = steal(tid);
+		}
+		if(t==NULL){
+			idle.fetch_add(1);
+			v = EMPTY;
+			if(dual){
+				v = ready->remove(tid);
+			}
+			else{
+				while(v==EMPTY && !stopping.load(std::memory_order_relaxed)){
+					v = ready->remove(tid);
+				}
+			}
+			idle.fetch_sub(1);
+			t = (Task*)(intptr_t)v;
+			if(t==NULL || t==&stopToken){
+				break;
+			}
+			handoffs.fetch_sub(1);
+			stats[tid].ui.wakes++;
+			stats[tid].ui.wakeNs+=nowNs()-t->stamp;
+		}
+		execute(t,tid);
+	}
+}
+
+void Executor::stop(int tid){
+	bool f = false;
+	if(stopping.compare_exchange_strong(f,true)){
+		// one token per worker, for any blocked in the ready queue
+		for(int i = 0; i<workers; i++){
+			ready->insert((int32_t)(intptr_t)&stopToken,tid);
+		}
+	}
+}
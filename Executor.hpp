@@ -0,0 +1,118 @@
+/*
+
+Copyright 2015 University of Rochester
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+
+
+#ifndef EXECUTOR_HPP
+#define EXECUTOR_HPP
+
+#ifndef _REENTRANT
+#define _REENTRANT		/* basic 3-lines for threads */
+#endif
+
+#include <stdint.h>
+#include <atomic>
+#include "ConcurrentPrimitives.hpp"
+#include "BlockPool.hpp"
+#include "RContainer.hpp"
+#include "RDualContainer.hpp"
+#include "WSDeque.hpp"
+
+
+// Work stealing task executor whose shared ready queue is
+// any RContainer, normally one of the dual containers.
+//
+// Each worker runs tasks from its own WSDeque, steals from the
+// other workers' deques when that runs dry, and then removes
+// from the ready queue.  On a dual container that remove
+// blocks, so an idle worker waits as a reservation rather than
+// sleeping, and a spawn made while anyone is idle is inserted
+// into the ready queue, handing the task straight to a waiter.
+// On a total container idle workers poll.
+//
+// Tasks are passed through the ready queue as their addresses,
+// so like the containers this needs 32 bit pointers.
+//
+// Fork/join is continuation passing: a task forks by calling
+// continueWith(), then spawning its children with itself as
+// parent.  When the last child finishes the parent is run
+// again with its continuation.
+
+class Executor;
+struct Task;
+typedef void (*TaskFn)(Executor* ex, Task* t, int tid);
+
+struct Task{
+	TaskFn fn;
+	Task* parent; // told when this task finishes, may be NULL
+	std::atomic<int> join; // outstanding children (+1 while fn runs)
+	bool forked;
+	int64_t in;
+	volatile int64_t out;
+	void* ctx;
+	uint64_t stamp; // ns at spawn through the ready queue
+};
+
+class Executor{
+	struct Stats{
+		int64_t tasks;
+		int64_t steals;
+		int64_t wakes; // tasks received from the ready queue
+		int64_t wakeNs; // total spawn to start time of those
+	};
+
+	RContainer* ready;
+	bool dual;
+	int workers;
+	padded<WSDeque<Task>>* deques;
+	padded<Stats>* stats;
+	BlockPool<Task>* bp;
+	std::atomic<int> idle; // workers waiting on the ready queue
+	char pad1[LEVEL1_DCACHE_LINESIZE-sizeof(std::atomic<int>)];
+	std::atomic<int> handoffs; // tasks in the ready queue not yet taken
+	char pad2[LEVEL1_DCACHE_LINESIZE-sizeof(std::atomic<int>)];
+	std::atomic<bool> stopping;
+	Task stopToken; // its address tells a waiting worker to exit
+
+	Task* steal(int tid);
+	void execute(Task* t, int tid);
+
+public:
+	Executor(RContainer* ready, int workers, bool glibc_mem);
+	~Executor();
+
+	Task* newTask(TaskFn fn, Task* parent, int tid);
+	void spawn(Task* t, int tid);
+	// t's fn is replaced by cont, which runs once
+	// the n children spawned after this call finish
+	void continueWith(Task* t, TaskFn cont, int n);
+
+	// worker loop, tid in [0,workers); returns after stop()
+	void run(int tid);
+	void stop(int tid);
+	bool isStopping(){return stopping.load(std::memory_order_relaxed);}
+
+	int64_t tasksRun(int tid){return stats[tid].ui.tasks;}
+	int64_t steals(int tid){return stats[tid].ui.steals;}
+	int64_t wakes(int tid){return stats[tid].ui.wakes;}
+	int64_t wakeNs(int tid){return stats[tid].ui.wakeNs;}
+
+	static uint64_t nowNs();
+};
+
+#endif
@@ -21,6 +21,7 @@ limitations under the License.
 
 
 #include "FCDualQueue.hpp"
+#include <x86intrin.h>
 // TODO: sometimes hangs on potato test
 
 
@@ -32,6 +33,7 @@ FCDualQueue::FCDualQueue(int task_num, bool glibc_mem){
 	fc_lock.store(0);
 	main_ds.clear();
 	consumers_caches = new padded<SimpleRing<ThreadNode*>>[task_num];
+	producers_caches = new padded<GrowRing<ThreadNode*>>[task_num];
 	int numlines;
 	numlines = (task_num*sizeof(ThreadNode*))/LEVEL1_DCACHE_LINESIZE + 1;
 	int size;
@@ -43,6 +45,22 @@ FCDualQueue::FCDualQueue(int task_num, bool glibc_mem){
 		consumers_caches[i].ui.resize(size);
 		thread_requests[i].set(false,false,0);
 	}
+	pub_head.store(NULL);
+	combining_pass = 0;
+	arrivals = 16;
+	rounds_limit = MAX_COMBINING_ROUNDS;
+	#ifdef FC_STATS
+	stats = new padded<FCStats>[task_num];
+	for(int i = 0; i<task_num; i++){
+		stats[i].ui.passes = 0;
+		stats[i].ui.cycles = 0;
+		stats[i].ui.max_cycles = 0;
+		stats[i].ui.scanned = 0;
+		stats[i].ui.handoffs = 0;
+		stats[i].ui.eliminated = 0;
+		stats[i].ui.lock_handoffs = 0;
+	}
+	#endif
 
 	/*for(int i = 0; i<300000; i++){
 		main_ds.push_back(i);
@@ -53,59 +71,206 @@ FCDualQueue::FCDualQueue(int task_num, bool glibc_mem){
 }
 
 
-void FCDualQueue::doFlatCombining(int tid){       
+// Runs rounds until one serves nothing, or the rounds limit or
+// cycle cap is reached.  Returns the next lock value: 0 to
+// release, or a waiting requester's tid+1 to hand it the lock
+// when we stopped on a cap with work still arriving.
+int FCDualQueue::doFlatCombining(int tid){       
 	SimpleRing<ThreadNode*>* consumers_array = &(consumers_caches[tid].ui);
-	bool finished = false;
+	GrowRing<ThreadNode*>* producers_array = &(producers_caches[tid].ui);
 	ThreadNode* my_node = &this->thread_requests[tid];
 
 	assert(fc_lock==tid+1);
+	uint64_t start = __rdtsc();
+	combining_pass++;
 
-	for(int j =0; j<MAX_COMBINING_ROUNDS && !finished; j++){
+	int served = 1;
+	for(int j = 0; j<rounds_limit && served!=0
+	  && (j==0 || __rdtsc()-start<MAX_COMBINING_CYCLES); j++){
+		served = 0;
 		consumers_array->clear();
-		for(int i = 0; i<task_num;i++){ // iterate over all requests
-			ThreadNode* cur_node = &this->thread_requests[i];
+		// iterate over the published requests
+		for(ThreadNode* cur_node = pub_head.load(std::memory_order_acquire);
+		  cur_node!=NULL; cur_node = cur_node->next){
+			#ifdef FC_STATS
+			stats[tid].ui.scanned++;
+			#endif
 			if(!cur_node->is_val()){continue;} // if it isn't valid, skip it
+			cur_node->age = combining_pass;
 
 			// if it's valid, it can't be changed by anyone other than the combiner
 			assert(cur_node->is_val());
 			if(!cur_node->is_consumer()){
-				// if producer, store the value in the data structure
 				int32_t item = cur_node->item();
-				//cout<<"ins"<<endl;
-				//if(item<0){cout<<"hot ins"<<endl;}
-				main_ds.push_back(item);
-				assert(cur_node->is_val() && !cur_node->is_consumer());
-				cur_node->set(false,false,0);
-				if(cur_node==my_node){finished=true;}
-				
+				if(consumers_array->size()!=0){
+					// a consumer is waiting, so main_ds is empty;
+					// hand the item straight over
+					assert(main_ds.empty());
+					ThreadNode* cons_node=consumers_array->back();
+					consumers_array->pop_back();
+					cons_node->set(false,false,item);
+					cur_node->set(false,false,0);
+					served++;
+					#ifdef FC_STATS
+					stats[tid].ui.eliminated++;
+					stats[tid].ui.handoffs++;
+					#endif
+				}
+				else if(!main_ds.empty()){
+					// older items are stored, queue up behind them
+					main_ds.push_back(item);
+					cur_node->set(false,false,0);
+				}
+				else{
+					// hold it back for a consumer later in the scan
+					producers_array->push_back(cur_node);
+					continue;
+				}
+				served++;
 			}
 			else{
-				// if consumer, cache request for later in traverse
-				consumers_array->push_back(cur_node);
-				assert(cur_node->is_val() && cur_node->is_consumer());
+				if(!main_ds.empty()){
+					// stored items go first
+					int32_t item = main_ds.front();
+					main_ds.pop_front();
+					cur_node->set(false,false,item);
+					#ifdef FC_STATS
+					stats[tid].ui.handoffs++;
+					#endif
+				}
+				else if(!producers_array->empty()){
+					// oldest producer held back this scan
+					ThreadNode* prod_node = producers_array->front();
+					producers_array->pop_front();
+					cur_node->set(false,false,prod_node->item());
+					prod_node->set(false,false,0);
+					served++;
+					#ifdef FC_STATS
+					stats[tid].ui.eliminated++;
+					stats[tid].ui.handoffs++;
+					#endif
+				}
+				else{
+					// nothing to give yet, cache request for later in traverse
+					consumers_array->push_back(cur_node);
+					assert(cur_node->is_val() && cur_node->is_consumer());
+					continue;
+				}
+				served++;
 			}
 
-
-			// match outstanding consumers
-			if(consumers_array->size()!=0 && main_ds.size()!=0){
-				int32_t item =main_ds.front();
-				//if(item<0){cout<<"hot rem"<<endl;}
-				//cout<<"rem"<<endl;
-				ThreadNode* cons_node=consumers_array->back();
-				consumers_array->pop_back();
-				main_ds.pop_front();
-				assert(cons_node->is_val());
-				if(cons_node==my_node){finished=true;}
-				cons_node->set(false,false,item);
-			}	
-
 		}// end inner loop
+
+		// the scan ended with spare producers; store their items in order
+		while(!producers_array->empty()){
+			ThreadNode* prod_node = producers_array->front();
+			producers_array->pop_front();
+			main_ds.push_back(prod_node->item());
+			prod_node->set(false,false,0);
+			served++;
+		}
 		assert(consumers_array->size()==0 || main_ds.size()==0);
+
+		// requests served per round, x16 fixed point moving average
+		arrivals+=((int)served*16-arrivals)/8;
+	}
+
+	// aim for about TARGET_PASS_REQUESTS per pass at the
+	// measured arrival rate, so busy periods use few long rounds
+	// and quiet ones many short ones
+	int limit = (TARGET_PASS_REQUESTS*16)/(arrivals>0?arrivals:1);
+	rounds_limit = std::max(MIN_COMBINING_ROUNDS,std::min(MAX_COMBINING_ROUNDS,limit));
+
+	if(combining_pass%CLEANUP_FREQUENCY==0){
+		unlinkAged();
+	}
+
+	// stopped on a cap with requests still arriving; pass the
+	// lock to one of them instead of letting all waiters race
+	int next_owner = 0;
+	if(served!=0){
+		for(ThreadNode* cur_node = pub_head.load(std::memory_order_acquire);
+		  cur_node!=NULL; cur_node = cur_node->next){
+			if(cur_node!=my_node && cur_node->is_val()){
+				next_owner = (cur_node-thread_requests)+1;
+				break;
+			}
+		}
 	}
 
+	#ifdef FC_STATS
+	uint64_t held = __rdtsc()-start;
+	stats[tid].ui.passes++;
+	stats[tid].ui.cycles+=held;
+	if(held>stats[tid].ui.max_cycles){stats[tid].ui.max_cycles = held;}
+	if(next_owner!=0){stats[tid].ui.lock_handoffs++;}
+	#endif
 	assert(fc_lock==tid+1);
+	return next_owner;
+}
+
+
+void FCDualQueue::enlist(ThreadNode* node){
+	node->active.store(true,std::memory_order_relaxed);
+	ThreadNode* h = pub_head.load();
+	do{
+		node->next = h;
+	}while(!pub_head.compare_exchange_weak(h,node));
 }
 
+// Combiner only.  A record can age out just as its owner
+// publishes a new request; the owner sees it inactive while
+// waiting and enlists it again.
+void FCDualQueue::unlinkAged(){
+	ThreadNode* prev = pub_head.load(std::memory_order_acquire);
+	if(prev==NULL){return;}
+	ThreadNode* cur = prev->next;
+	while(cur!=NULL){
+		ThreadNode* next = cur->next;
+		if(!cur->is_val() && combining_pass-cur->age>MAX_RECORD_AGE){
+			prev->next = next;
+			cur->active.store(false,std::memory_order_release);
+		}
+		else{
+			prev = cur;
+		}
+		cur = next;
+	}
+}
+
+// Spin until our request is served, combining when the lock
+// is free or handed to us.  The lock is watched on every spin;
+// only retaking it after a pass that left us waiting backs off.
+void FCDualQueue::awaitCombining(ThreadNode* thread_node, int tid){
+	int spins = 0;
+	int next_try = 0;
+	int backoff = 1;
+	while(thread_node->is_val()){
+
+		// get (back) on the publication list
+		if(!thread_node->active.load(std::memory_order_acquire)){
+			enlist(thread_node);
+		}
+
+		// Try to combine
+		int l = fc_lock.load(std::memory_order_acquire);
+		if(l==tid+1){
+			// a combiner handed us the lock
+			fc_lock.store(doFlatCombining(tid),std::memory_order_release);
+		}
+		else if(l==0 && spins>=next_try){
+			int a = 0;
+			if (fc_lock.compare_exchange_strong(a, tid+1)){
+				// This thread is now the combiner
+				fc_lock.store(doFlatCombining(tid),std::memory_order_release);
+				// still waiting means no partner yet
+				backoff = std::min(backoff*2,MAX_RETRY_BACKOFF);
+				next_try = spins+backoff;
+			}
+		}
+		spins++;
+	}
+}
 
 //void inline ThreadNode::set(bool is_consumer, bool is_val, int32_t item)
 
@@ -118,23 +283,9 @@ void FCDualQueue::insert(int32_t value,int tid){
 	assert(!thread_node->is_val());
 	thread_node->set(false,true,value);
 	//if(value<0){cout<<"hot post"<<endl;}
-	int rounds = 0;
 
 	// wait for combining
-	while(thread_node->is_val()){
-
-		// Try to combine
-		if (rounds%COMBINING_LIST_CHECK_FREQUENCY==0
-		 && fc_lock.load() == 0){
-			int a = 0;                
-			if (fc_lock.compare_exchange_strong(a, tid+1)){
-				 // This thread is now the combiner
-				 doFlatCombining(tid);
-				 fc_lock.store(0);
-			}
-		}
-		rounds++;
-	}
+	awaitCombining(thread_node,tid);
 
 	return;
 
@@ -146,24 +297,39 @@ int32_t FCDualQueue::remove(int tid){
 	ThreadNode* thread_node = &this->thread_requests[tid];
 	assert(!thread_node->is_val());
 	thread_node->set(true,true,0);
-	int rounds =0;
 
 	// wait for combining
-	while(thread_node->is_val()){
-
-		// Try to combine
-		if (rounds%COMBINING_LIST_CHECK_FREQUENCY==0
-		 && fc_lock.load() == 0){
-			int a = 0;                
-			if (fc_lock.compare_exchange_strong(a, tid+1)){
-				 // This thread is now the combiner
-				 doFlatCombining(tid);
-				 fc_lock.store(0);
-			}
-		}
-		rounds++;
-	}
+	awaitCombining(thread_node,tid);
 
 	return thread_node->item();
 }
 
+void FCDualQueue::releaseSlot(int tid){
+	// both operations wait for their request to be served,
+	// so the departing thread leaves nothing published
+	assert(!thread_requests[tid].is_val());
+	consumers_caches[tid].ui.clear();
+	producers_caches[tid].ui.clear();
+}
+
+void FCDualQueue::conclude(){
+	#ifdef FC_STATS
+	uint64_t passes = 0, cycles = 0, max_cycles = 0, scanned = 0;
+	uint64_t handoffs = 0, eliminated = 0, lock_handoffs = 0;
+	for(int i = 0; i<task_num; i++){
+		scanned+=stats[i].ui.scanned;
+		handoffs+=stats[i].ui.handoffs;
+		eliminated+=stats[i].ui.eliminated;
+		lock_handoffs+=stats[i].ui.lock_handoffs;
+		passes+=stats[i].ui.passes;
+		cycles+=stats[i].ui.cycles;
+		if(stats[i].ui.max_cycles>max_cycles){max_cycles = stats[i].ui.max_cycles;}
+	}
+	std::cout<<"combining_passes="<<passes
+	  <<" records_per_pass="<<(passes?(double)scanned/passes:0)
+	  <<" hold_cycles_mean="<<(passes?cycles/passes:0)
+	  <<" hold_cycles_max="<<max_cycles
+	  <<" eliminated_fraction="<<(handoffs?(double)eliminated/handoffs:0)
+	  <<" lock_handoffs="<<lock_handoffs<<" rounds_limit="<<rounds_limit<<std::endl;
+	#endif
+}
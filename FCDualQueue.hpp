@@ -32,11 +32,13 @@ limitations under the License.
 #include <forward_list>
 #include <deque>
 #include "SimpleRing.hpp"
+#include "GrowRing.hpp"
+#include "ThreadRegistry.hpp"
 
 
 
 
-class FCDualQueue : public virtual RDualContainer, public Reportable {
+class FCDualQueue : public virtual RDualContainer, public Reportable, public SlotOwner {
 
 public:
     // Used for each thread to register their request
@@ -48,14 +50,24 @@ public:
 
 	std::atomic<uint64_t> ui;
 
+	// publication list linkage, see enlist()
+	ThreadNode* next;
+	std::atomic<bool> active; // on the publication list
+	uint64_t age; // combining pass that last served this request
+
 	// padding
 	char pad1[LEVEL1_DCACHE_LINESIZE
 	-sizeof(std::atomic<uint64_t>)
-	-sizeof(std::atomic<int>)
+	-sizeof(ThreadNode*)
+	-sizeof(std::atomic<bool>)
+	-sizeof(uint64_t)
 	];
 
 	ThreadNode(){
 		set(false,false,0);
+		next = NULL;
+		active.store(false);
+		age = 0;
 	}
 
 	ThreadNode(bool is_consumer, bool is_val, int32_t item){
@@ -85,23 +97,62 @@ public:
 	std::atomic<int> fc_lock;
 	char pad1[LEVEL1_DCACHE_LINESIZE-sizeof(std::atomic<int>)];
 
-	// Main data structure
-	std::list<int32_t> main_ds;
-	char pad2[LEVEL1_DCACHE_LINESIZE-sizeof(std::list<int32_t>)];
+	// Main data structure, only touched by the combiner
+	GrowRing<int32_t> main_ds;
+	char pad2[LEVEL1_DCACHE_LINESIZE-sizeof(GrowRing<int32_t>)];
 
-	// Thread request array
+	// Thread request array, one record per tid
 	ThreadNode* thread_requests;
 	char pad3[LEVEL1_DCACHE_LINESIZE-sizeof(ThreadNode*)];
 
+	// Publication list of the records of active threads.
+	// Threads push their record on at the head when they find
+	// it inactive; only the combiner unlinks, and never the head.
+	std::atomic<ThreadNode*> pub_head;
+	char pad4[LEVEL1_DCACHE_LINESIZE-sizeof(std::atomic<ThreadNode*>)];
+
+	// combining passes so far, only touched by the combiner
+	uint64_t combining_pass;
+
 	// Thread local request caches
 	padded<SimpleRing<ThreadNode*>>* consumers_caches; // TODO switch back to deque, test
+	// producers held back during a scan for elimination, oldest first
+	padded<GrowRing<ThreadNode*>>* producers_caches;
 
 	// number of threads
 	int task_num = 1;
 
+	#ifdef FC_STATS
+	// per combiner time spent holding fc_lock
+	struct FCStats{
+		uint64_t passes;
+		uint64_t cycles;
+		uint64_t max_cycles;
+		uint64_t scanned; // records visited
+		uint64_t handoffs; // items given to consumers
+		uint64_t eliminated; // of those, straight from a producer
+		uint64_t lock_handoffs; // passes ending by handing the lock over
+	};
+	padded<FCStats>* stats;
+	#endif
+
+	// adaptive combining, only touched by the combiner
+	int arrivals; // requests served per round, x16 moving average
+	int rounds_limit; // rounds allowed in the next pass
+
 	// Combining constants
-	const int MAX_COMBINING_ROUNDS = 10;
-	const int COMBINING_LIST_CHECK_FREQUENCY = 10;
+	const int MIN_COMBINING_ROUNDS = 1;
+	const int MAX_COMBINING_ROUNDS = 64;
+	const int TARGET_PASS_REQUESTS = 64;
+	// cap on the time a combiner holds the lock, checked per round
+	const uint64_t MAX_COMBINING_CYCLES = 100000;
+	// spins a waiter left unserved by its own pass waits at most
+	// before taking the free lock again
+	const int MAX_RETRY_BACKOFF = 64;
+	// every CLEANUP_FREQUENCY passes the combiner unlinks idle
+	// records not served in the last MAX_RECORD_AGE passes
+	const uint64_t CLEANUP_FREQUENCY = 100;
+	const uint64_t MAX_RECORD_AGE = 100;
 
 	// constructor
 	FCDualQueue(int task_num, bool glibc);
@@ -113,9 +164,16 @@ public:
 	// Synchronous Queue interface's get routine.
 	int32_t remove(int tid);
 
+	void releaseSlot(int tid);
+
+	void conclude();
+
 private:
     // Actual combining routine
-    void doFlatCombining(int tid);
+    int doFlatCombining(int tid);
+    void awaitCombining(ThreadNode* thread_node, int tid);
+    void enlist(ThreadNode* node);
+    void unlinkAged();
 
 };
 
@@ -83,7 +83,7 @@ void GenericDual::conclude(){
 	cout<<"antidata.size@End="<<i<<endl;
 }
 
-inline int32_t GenericDual::finished_insert(placeholder* ph, bool polarity,int tid){
+inline int32_t GenericDual::finished_insert(placeholder* ph, bool polarity, DualWaiter* w, bool* parked, int tid){
 	int32_t val;
 	if(polarity==DATA){// I am DATA
 		return OK; // we're successfully insertd, so we're done
@@ -92,6 +92,16 @@ inline int32_t GenericDual::finished_insert(placeholder* ph, bool polarity,int t
 		int i = 0;
 		assert(ph->aborted() !=1);
 		assert(ph->valid() ==1);
+		if(w!=NULL){
+			// park instead of spinning, unless the
+			// satisfier has already been and gone
+			if(ph->waiter.exchange(w)==NULL){
+				*parked = true;
+				return EMPTY;
+			}
+			assert(ph->sat());
+			return ph->val();
+		}
 		while(ph->sat()==false){
 			assert(ph->val()==0 || ph->sat());
 		} // spin waiting for data
@@ -109,6 +119,7 @@ inline int32_t GenericDual::mix(placeholder* ph, placeholder* opp_ph,bool polari
 	if(polarity==DATA){ // I am DATA
 		bool b = opp_ph->satisfy(ph->val());
 		assert(b);
+		wakeWaiter(opp_ph,ph->val(),tid);
 		return OK;
 	}
 	else{// I am ANTIDATA
@@ -118,16 +129,30 @@ inline int32_t GenericDual::mix(placeholder* ph, placeholder* opp_ph,bool polari
 	}
 }
 
-inline GenericDual::placeholder* GenericDual::allocPlaceholder(int32_t val, int tid){
+// Called by the thread whose satisfy() succeeded on opp_ph.
+// A remover parked there is owed a wake, and its share of
+// the placeholder's retirement; otherwise DONE tells it,
+// if it arrives later, to take the value itself.
+inline void GenericDual::wakeWaiter(placeholder* opp_ph, int32_t val, int tid){
+	if(!opp_ph->parks){return;}
+	DualWaiter* w = opp_ph->waiter.exchange(WAITER_DONE);
+	if(w!=NULL){
+		retire(opp_ph,tid); // on the waiter's behalf
+		w->wake(val,tid);
+	}
+}
+
+inline GenericDual::placeholder* GenericDual::allocPlaceholder(int32_t val, bool parks, int tid){
 	placeholder* ph = bp->alloc(tid);
 	if(ph==NULL){// we ran out of memory...
 		errexit("Out of memory on placeholder alloc!\n");
 	}
 	ph->init(val,INVALID); 
+	ph->parks = parks;
 	return ph;
 }
 
-inline int32_t GenericDual::validateAndComplete(placeholder* ph, int32_t val, bool polarity, int tid){
+inline int32_t GenericDual::validateAndComplete(placeholder* ph, int32_t val, bool polarity, DualWaiter* w, bool* parked, int tid){
 	placeholder_local swap_old;
 	placeholder_local swap_new;
 	swap_old.init(val,INVALID);
@@ -135,7 +160,7 @@ inline int32_t GenericDual::validateAndComplete(placeholder* ph, int32_t val, bo
 	if(ph->CAS(swap_old,swap_new)){
 		assert(ph->aborted()==0);
 		assert(ph->valid()==1);
-		return finished_insert(ph,polarity,tid);
+		return finished_insert(ph,polarity,w,parked,tid);
 	}
 	return EMPTY; // failed to validate
 }
@@ -310,6 +335,7 @@ inline uint64_t GenericDual::helpRequestNB(cptr_local<Request> req, int tid){
 		if(opp_ph->satisfy(req->val,req.ptr())){
 			// satisfied opposite
 			ret = SATISFIED;
+			wakeWaiter(opp_ph,req->val,tid);
 			assert(opp_ph->state()==SATISFIED);
 			assert(opp_ph->val()!=0);
 			assert(opp_ph->req()==req.ptr());
@@ -338,14 +364,15 @@ inline uint64_t GenericDual::helpRequestNB(cptr_local<Request> req, int tid){
 
 
 
-inline int32_t GenericDual::remsert(int32_t val,bool polarity,int tid){
+inline int32_t GenericDual::remsert(int32_t val,bool polarity,DualWaiter* w,int tid){
 	placeholder* ph=NULL;
 	bool nb = nonBlocking && (polarity == DATA);
+	bool parked = false;
 	int contentioncounter=0;
 	int32_t ret=EMPTY;
 
 	// allocate placeholder
-	ph = allocPlaceholder(val, tid);// reusing this is NOT SAFE, we are guaranteed to be on a retired list
+	ph = allocPlaceholder(val, w!=NULL, tid);// reusing this is NOT SAFE, we are guaranteed to be on a retired list
 
 	// precheck optimization 
 	ret = doOppositeCheck(ph, polarity, nb, tid);
@@ -364,8 +391,8 @@ inline int32_t GenericDual::remsert(int32_t val,bool polarity,int tid){
 
 		// empty check failed ....
 		// so now we now try to validate our placeholder
-		ret = validateAndComplete(ph, val, polarity, tid);
-		if(ret!=EMPTY){break;} // validated self and waited if necessary, so done.
+		ret = validateAndComplete(ph, val, polarity, w, &parked, tid);
+		if(ret!=EMPTY || parked){break;} // validated self and waited (or parked) if necessary, so done.
 
 		assert(ph->val() == val);
 
@@ -381,10 +408,12 @@ inline int32_t GenericDual::remsert(int32_t val,bool polarity,int tid){
 		if(contentioncounter>0){contention_manager(polarity,tid);}
 
 		// get a new placeholder and try again
-		ph = allocPlaceholder(val,tid);
+		ph = allocPlaceholder(val,w!=NULL,tid);
 	}
 	//clearHazards(tid);
-	retire(ph, tid);
+	if(!parked){
+		retire(ph, tid); // a parked placeholder is retired by its satisfier
+	}
 	
 
 	return ret;
@@ -432,12 +461,16 @@ inline void GenericDual::retire(placeholder* ph, int tid){
 
 int32_t GenericDual::remove(int tid){
 	int32_t rtn;
-	rtn =  remsert((int32_t)NULL,ANTIDATA,tid);
+	rtn =  remsert((int32_t)NULL,ANTIDATA,NULL,tid);
 	return rtn;
 }
+int32_t GenericDual::removeAsync(DualWaiter* w, int tid){
+	assert(w!=NULL);
+	return remsert((int32_t)NULL,ANTIDATA,w,tid);
+}
 void GenericDual::insert(int32_t val, int tid){
 	int32_t rtn;
-	rtn= remsert(val,DATA,tid);
+	rtn= remsert(val,DATA,NULL,tid);
 	return;
 }
 
@@ -459,4 +492,13 @@ GenericDual::~GenericDual(){
 
 }
 
-
+void GenericDual::releaseSlot(int tid){
+	clearHazards(tid);
+	// pass the slot on to the underlying containers
+	for(int i = 0; i<2; i++){
+		SlotOwner* o = dynamic_cast<SlotOwner*>(q_array[i]);
+		if(o!=NULL){
+			o->releaseSlot(tid);
+		}
+	}
+}
@@ -28,6 +28,7 @@ limitations under the License.
 #include "ConcurrentPrimitives.hpp"
 #include "RDualContainer.hpp"
 #include "BlockPool.hpp"
+#include "ThreadRegistry.hpp"
 #include <list>
 #include <atomic>
 #include <vector>
@@ -40,7 +41,10 @@ limitations under the License.
 #define SATISFIED (0x300000000)
 #define INVALID (0x000000000)
 
-class GenericDual : public virtual RDualContainer, public Reportable{
+// placeholder waiter word once its satisfier has been by
+#define WAITER_DONE ((DualWaiter*)1)
+
+class GenericDual : public virtual RAsyncDualContainer, public Reportable, public SlotOwner{
 
 private:
 
@@ -91,6 +95,8 @@ private:
 	public:
 		std::atomic<uint64_t> all;
 		std::atomic<bool> abandoned;	
+		std::atomic<DualWaiter*> waiter; // parked remover, or WAITER_DONE
+		bool parks; // set before insertion, so satisfiers know to look
 		//pad to cache line size
 		//char pad[LEVEL1_DCACHE_LINESIZE-(sizeof(std::atomic<uint64_t>)+sizeof(std::atomic<bool>))];
 
@@ -101,8 +107,9 @@ private:
 			a = (uint32_t)val;
 			a += state;
 			all=a;
-			abandoned.store(false,std::memory_order::memory_order_relaxed);
-			all.store(a,std::memory_order::memory_order_release);
+			abandoned.store(false,std::memory_order_relaxed);
+			waiter.store(NULL,std::memory_order_relaxed);
+			all.store(a,std::memory_order_release);
 		}
 		int32_t inline val(){return (int32_t)(all&0x00000000ffffffff);}
 		bool inline valid(){
@@ -133,7 +140,7 @@ private:
 		}
 
 		bool inline abandon(){
-			bool res = abandoned.load(std::memory_order::memory_order_acquire);
+			bool res = abandoned.load(std::memory_order_acquire);
 			bool f = false;
 			res = (!res) && abandoned.compare_exchange_strong(f,true);
 			return res;
@@ -148,9 +155,9 @@ private:
 		std::atomic<placeholder*> ph;
 		std::atomic<uint64_t> key;
 		void init(int32_t val, placeholder* ph, uint64_t key){
-			this->val.store(val,std::memory_order::memory_order_relaxed);
-			this->ph.store(ph,std::memory_order::memory_order_relaxed);
-			this->key.store(key,std::memory_order::memory_order_release);
+			this->val.store(val,std::memory_order_relaxed);
+			this->ph.store(ph,std::memory_order_relaxed);
+			this->key.store(key,std::memory_order_release);
 		}
 	};
 
@@ -162,14 +169,15 @@ private:
 	bool nonBlocking;
 	
 
-	inline int32_t finished_insert(placeholder* ph, bool polarity,int tid);
+	inline int32_t finished_insert(placeholder* ph, bool polarity, DualWaiter* w, bool* parked, int tid);
 	inline int32_t mix(placeholder* ph, placeholder* opp_ph,bool polarity,int tid);
-	inline int32_t remsert(int32_t val,bool polarity,int tid);
+	inline int32_t remsert(int32_t val,bool polarity,DualWaiter* w,int tid);
+	inline void wakeWaiter(placeholder* opp_ph, int32_t val, int tid);
 	inline void contention_manager(bool polarity,int tid);
 
 
-	placeholder* allocPlaceholder(int32_t val, int tid);
-	inline int32_t validateAndComplete(placeholder* ph, int32_t val, bool polarity, int tid);
+	placeholder* allocPlaceholder(int32_t val, bool parks, int tid);
+	inline int32_t validateAndComplete(placeholder* ph, int32_t val, bool polarity, DualWaiter* w, bool* parked, int tid);
 	inline int32_t doOppositeCheck(placeholder* ph, bool polarity, bool nb, int tid);
 	inline int32_t oppositeCheck(placeholder* ph, bool polarity, bool nb, int tid);
 	inline int32_t oppositeCheckNB(placeholder* ph, bool polarity, bool nb, int tid);
@@ -190,9 +198,11 @@ public:
 	
 	int32_t remove(int tid);
 	void insert(int32_t val,int tid);
+	int32_t removeAsync(DualWaiter* w,int tid);
 	GenericDual(RContainer* dataqueue,RContainer* antidataqueue, bool nonblocking, int task_num, bool glibc_mem);
 	~GenericDual();
 	void conclude();
+	void releaseSlot(int tid);
 
 
 };
@@ -0,0 +1,103 @@
+/*
+
+Copyright 2015 University of Rochester
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+
+
+#ifndef GROW_RING_HPP
+#define GROW_RING_HPP
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+// Sequential FIFO on a power of two ring that doubles when
+// full, so steady state pushes and pops never allocate.
+// Not thread safe; owned by whoever holds the combiner lock.
+template <class T>
+class GrowRing{
+
+	T* ring;
+	uint32_t mask;
+	uint32_t head; // next pop, free running
+	uint32_t tail; // next push, free running
+
+	void grow(){
+		uint32_t sz = mask+1;
+		T* r = (T*)malloc(sizeof(T)*sz*2);
+		// unwrap into the front of the new ring
+		uint32_t h = head&mask;
+		memcpy(r,ring+h,sizeof(T)*(sz-h));
+		memcpy(r+(sz-h),ring,sizeof(T)*h);
+		free(ring);
+		ring = r;
+		mask = sz*2-1;
+		tail = tail-head;
+		head = 0;
+	}
+
+public:
+	GrowRing(uint32_t size=1024){
+		assert((size&(size-1))==0);
+		ring = (T*)malloc(sizeof(T)*size);
+		mask = size-1;
+		head = 0;
+		tail = 0;
+	}
+
+	~GrowRing(){
+		free(ring);
+	}
+
+	void inline push_back(T val){
+		if(tail-head>mask){
+			grow();
+		}
+		ring[tail&mask] = val;
+		tail++;
+	}
+
+	T inline front(){
+		return ring[head&mask];
+	}
+
+	void inline pop_front(){
+		head++;
+		__builtin_prefetch(&ring[(head+1)&mask]);
+	}
+
+	uint32_t inline size(){
+		return tail-head;
+	}
+
+	bool inline empty(){
+		return tail==head;
+	}
+
+	void clear(){
+		head = 0;
+		tail = 0;
+	}
+
+	uint32_t capacity(){
+		return mask+1;
+	}
+};
+
+
+#endif
@@ -0,0 +1,146 @@
+/*
+
+Copyright 2015 University of Rochester
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+
+
+// Keyed rendezvous dual map.
+//
+// The protocol is GenericDual's blocking one; see GenericDual.cpp.
+
+
+#include <iostream>
+#include "KeyedDual.hpp"
+
+using namespace std;
+
+KeyedDual::KeyedDual(RMap* datamap, RMap* antidatamap, int task_num, bool glibc_mem){
+	maps[DATA] = datamap;
+	maps[ANTIDATA] = antidatamap;
+	this->task_num = task_num;
+	bp = new BlockPool<placeholder>(task_num,glibc_mem);
+	stats = new padded<Stats>[task_num];
+	for(int i = 0; i<task_num; i++){
+		stats[i].ui.waits = 0;
+		stats[i].ui.retries = 0;
+	}
+}
+
+void KeyedDual::conclude(){
+	int64_t waits = 0;
+	int64_t retries = 0;
+	for(int i = 0; i<task_num; i++){
+		waits+=stats[i].ui.waits;
+		retries+=stats[i].ui.retries;
+	}
+	cout<<"waits="<<waits<<" retries="<<retries<<endl;
+}
+
+KeyedDual::placeholder* KeyedDual::allocPlaceholder(int32_t val, int tid){
+	placeholder* ph = bp->alloc(tid);
+	if(ph==NULL){// we ran out of memory...
+		errexit("Out of memory on placeholder alloc!\n");
+	}
+	ph->init(val,INVALID);
+	return ph;
+}
+
+// the owner and whoever unmapped the placeholder both retire
+// it; the second to get here frees it
+void KeyedDual::retire(placeholder* ph, int tid){
+	if(ph->abandon()){
+		return;
+	}
+	bp->free(ph,tid);
+}
+
+// unmaps key from the opposite map until it is gone or a
+// valid placeholder turns up, which we mix with
+int32_t KeyedDual::oppositeCheck(int32_t key, placeholder* ph, bool polarity, int tid){
+	int32_t remove_val;
+	placeholder* opp_ph;
+	int32_t ret;
+	while(true){
+		remove_val = maps[!polarity]->unmap(key,tid);
+		if(remove_val==EMPTY){
+			return EMPTY;
+		}
+		opp_ph = (placeholder*)remove_val;
+		if(opp_ph->CAS(opp_ph->val(),INVALID,ABORTED)){
+			// never validated, so its owner will retry
+			retire(opp_ph,tid);
+			continue;
+		}
+		// opp_ph is valid
+		if(polarity==DATA){
+			bool b = opp_ph->satisfy(ph->val());
+			assert(b);
+			ret = OK;
+		}
+		else{
+			ret = opp_ph->val();
+		}
+		retire(opp_ph,tid);
+		return ret;
+	}
+}
+
+int32_t KeyedDual::validateAndComplete(placeholder* ph, bool polarity, int tid){
+	if(!ph->CAS(ph->val(),INVALID,VALID)){
+		return EMPTY; // aborted by an opposite check
+	}
+	if(polarity==DATA){
+		return OK;
+	}
+	stats[tid].ui.waits++;
+	while(ph->sat()==false){} // spin waiting for data
+	return ph->val();
+}
+
+int32_t KeyedDual::remsert(int32_t key, int32_t val, bool polarity, int tid){
+	assert(key!=0); // 0 used as EMPTY signal
+	placeholder* ph = allocPlaceholder(val,tid);
+
+	// precheck, before anything is mapped
+	int32_t ret = oppositeCheck(key,ph,polarity,tid);
+	if(ret!=EMPTY){
+		retire(ph,tid); // extra retire since nobody will unmap it
+	}
+
+	while(ret==EMPTY){
+		maps[polarity]->map(key,(int32_t)ph,tid);
+		ret = oppositeCheck(key,ph,polarity,tid);
+		if(ret!=EMPTY){break;} // mixed; our placeholder will be aborted
+		ret = validateAndComplete(ph,polarity,tid);
+		if(ret!=EMPTY){break;}
+		// aborted by an opposite that then mixed
+		// elsewhere or found nothing; try again
+		stats[tid].ui.retries++;
+		retire(ph,tid);
+		ph = allocPlaceholder(val,tid);
+	}
+	retire(ph,tid);
+	return ret;
+}
+
+void KeyedDual::insert(int32_t key, int32_t val, int tid){
+	remsert(key,val,DATA,tid);
+}
+
+int32_t KeyedDual::remove(int32_t key, int tid){
+	return remsert(key,(int32_t)NULL,ANTIDATA,tid);
+}
@@ -0,0 +1,133 @@
+/*
+
+Copyright 2015 University of Rochester
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+
+
+// Keyed rendezvous dual map.
+//
+// GenericDual's placeholder validation protocol over a pair of
+// multimaps instead of a pair of queues.  insert(key,val) and
+// remove(key) each put a placeholder under key in their own map,
+// then unmap key from the other map: an invalid placeholder found
+// there is aborted and skipped, a valid one is mixed with, and if
+// there is none the operation validates its own placeholder, at
+// which point a remove waits for an insert of the same key to
+// satisfy it.  An operation whose placeholder was aborted before
+// it could validate starts again with a new one.  Keys that no
+// one is waiting on cost nothing, so many distinct keys are fine.
+//
+// Blocking only; there is no peek on the maps for the
+// nonblocking variant's requests to name.  The maps need to keep
+// duplicates, so they are built with appendDuplicates.
+
+
+#ifndef KEYED_DUAL_H
+#define KEYED_DUAL_H
+
+#ifndef _REENTRANT
+#define _REENTRANT		/* basic 3-lines for threads */
+#endif
+
+#include <atomic>
+#include "ConcurrentPrimitives.hpp"
+#include "RDualContainer.hpp"
+#include "BlockPool.hpp"
+#include "GenericDual.hpp"
+#include "MichaelOrderedSet.hpp"
+#include "SplitOrderedMap.hpp"
+
+class KeyedDual : public virtual RKeyedDualContainer, public Reportable{
+
+	// GenericDual's placeholder, less the request
+	// field that only the nonblocking variant uses
+	class placeholder{
+	public:
+		std::atomic<uint64_t> all;
+		std::atomic<bool> abandoned;
+
+		void inline init(int32_t val, uint64_t state){
+			abandoned.store(false,std::memory_order::memory_order_relaxed);
+			all.store((uint64_t)(uint32_t)val+state,std::memory_order::memory_order_release);
+		}
+		int32_t inline val(){return (int32_t)(all&0x00000000ffffffff);}
+		uint64_t inline state(){return (all&FLAG_MASK);}
+		bool inline sat(){return (all&FLAG_MASK) == SATISFIED;}
+
+		bool inline CAS(int32_t val, uint64_t oldstate, uint64_t newstate){
+			uint64_t oldval = (uint64_t)(uint32_t)val+oldstate;
+			return all.compare_exchange_strong(oldval,(uint64_t)(uint32_t)val+newstate);
+		}
+		// only a valid antidata placeholder (val NULL) can be satisfied
+		bool inline satisfy(int32_t arg){
+			uint64_t oldval = VALID;
+			return all.compare_exchange_strong(oldval,(uint64_t)(uint32_t)arg+SATISFIED);
+		}
+		bool inline abandon(){
+			bool res = abandoned.load(std::memory_order::memory_order_acquire);
+			bool f = false;
+			res = (!res) && abandoned.compare_exchange_strong(f,true);
+			return res;
+		}
+	};
+
+	struct Stats{
+		int64_t waits; // removes that validated and waited
+		int64_t retries; // placeholders aborted before validating
+	};
+
+	RMap* maps[2];
+	BlockPool<placeholder>* bp;
+	padded<Stats>* stats;
+	int task_num;
+
+	placeholder* allocPlaceholder(int32_t val, int tid);
+	void retire(placeholder* ph, int tid);
+	int32_t oppositeCheck(int32_t key, placeholder* ph, bool polarity, int tid);
+	int32_t validateAndComplete(placeholder* ph, bool polarity, int tid);
+	int32_t remsert(int32_t key, int32_t val, bool polarity, int tid);
+
+public:
+	KeyedDual(RMap* datamap, RMap* antidatamap, int task_num, bool glibc_mem);
+
+	void conclude();
+
+	void insert(int32_t key, int32_t val, int tid);
+	int32_t remove(int32_t key, int tid);
+};
+
+class KeyedDualFactory : public RideableFactory{
+	bool hashed;
+public:
+	// hashed picks SplitOrderedMap over MichaelOrderedMap
+	KeyedDualFactory(bool hashed){this->hashed = hashed;}
+	KeyedDual* build(GlobalTestConfig* gtc){
+		bool glibc = gtc->environment["glibc"]=="1";
+		RMap* m[2];
+		for(int i = 0; i<2; i++){
+			if(hashed){
+				m[i] = new SplitOrderedMap(gtc->task_num,MichaelOrderedMap::appendDuplicates,glibc);
+			}
+			else{
+				m[i] = new MichaelOrderedMap(gtc->task_num,MichaelOrderedMap::appendDuplicates,glibc);
+			}
+		}
+		return new KeyedDual(m[DATA],m[ANTIDATA],gtc->task_num,glibc);
+	}
+};
+
+#endif
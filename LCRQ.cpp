@@ -299,7 +299,7 @@ LCRQ::LCRQ(int t_num){
 	LCRQ(t_num,false);
 }
 
-LCRQ::LCRQ(int t_num, bool glibc_mem){
+LCRQ::LCRQ(int t_num, bool glibc_mem, ReclaimerConfig rc){
 	int i,j;
 	// init block pool
 	bp = new BlockPool<struct CRQ>(t_num,glibc_mem);
@@ -317,19 +317,16 @@ LCRQ::LCRQ(int t_num, bool glibc_mem){
 	}*/
 
 
+	reclaimer = buildReclaimer<struct CRQ>(rc,t_num,bp);
+
 	head.ptr = (struct CRQ*)bp->alloc(0); //(malloc(sizeof(struct CRQ));
 	head.cntr=0;
 	initRingQueue(head.ptr,0);
+	reclaimer->onAlloc(head.ptr,0);
 	head_index = 0;
 	tail=head;
 	tail.cntr = 10;
-	hazard = new struct volatile_padded<uint64_t>[t_num];
 	task_num = t_num;
-	retired = new struct volatile_padded<std::list<struct CRQ*>*>[t_num];
-	for(i=0;i<task_num;i++){
-		retired[i].ui=new std::list<struct CRQ*>();
-		hazard[i].ui=UINT64_MAX;
-	}
 
 }
 
@@ -354,48 +351,11 @@ LCRQ::~LCRQ(){
 		garbage = next_crq;
 	}*/
 	//while(this->dequeue()!=EMPTY){}
-	delete[] retired;
-	delete[] hazard;
+	delete reclaimer;
 }
 
-void LCRQ::retire(int tid, struct CRQ* crq){
-	int i;
-	uint64_t min_hazard;
-	min_hazard = UINT64_MAX;
-	long idx;
-	struct CRQ old;
-	struct CRQ* garbage;
-	old = *crq;
-	for(i=0;i<task_num;i++){
-		if(hazard[i].ui<min_hazard){
-			min_hazard=hazard[i].ui;
-		}
-	}
-
-	if(min_hazard>crq->index){
-		// crq is already clear,
-		// we can free it
-		bp->free(crq,tid);
-	}
-	else{
-		// crq is not clear
-		// append it to the retired list
-		retired[tid].ui->push_back(crq);
-		
-	}
-
-	// while we're here, lets empty our retired list
-	// anything on our list is unique,
-	// since it got there by us successfully removing it from
-	// the head pointer
-	while(retired[tid].ui->size()>0 && (*retired[tid].ui->begin())->index<min_hazard){
-
-		garbage = *retired[tid].ui->begin();
-		idx = garbage->index;
-		retired[tid].ui->pop_front(); 
-		bp->free(garbage,tid);
-	}
-
+void LCRQ::releaseSlot(int tid){
+	reclaimer->releaseSlot(tid);
 }
 
 int32_t LCRQ::dequeue(int tid){
@@ -407,19 +367,22 @@ int32_t LCRQ::dequeue(int tid){
 
 
 	while(true){
-		hazard[tid].ui= head_index; // get head_index, it is guaranteed to be 
+		reclaimer->begin(tid,head_index); // get head_index, it is guaranteed to be 
 								// less than or equal to the actual head index
 								// we set it as our hazard index.  Nothing
 								// above it can be freed
 		crq = head;
+		if(!reclaimer->stable(tid)){
+			continue;
+		}
 
 		v = crqdequeue(crq.ptr);
 		if(v!= EMPTY){
-			hazard[tid].ui=UINT64_MAX; // reset our hazard index
+			reclaimer->end(tid); // reset our hazard index
 			return v;  // dequeued successfully, return
 		} 
 		if(crq.ptr->next==NULL){
-			hazard[tid].ui=UINT64_MAX; // reset our hazard index
+			reclaimer->end(tid); // reset our hazard index
 			return EMPTY; // queue is totally empty, return
 		} 
 		if(!seal(crq.ptr)){
@@ -443,8 +406,8 @@ int32_t LCRQ::dequeue(int tid){
 			// index.  Thus, so long as everyone's hazard index is above a crq's index
 			// we can free it
 			__sync_fetch_and_add (&head_index, 1);  // update head index
-			hazard[tid].ui=UINT64_MAX; // this line breaks things (does it still?)
-			retire(tid,crq.ptr);
+			reclaimer->end(tid); // this line breaks things (does it still?)
+			reclaimer->retire(crq.ptr,tid);
 		}
 	}
 
@@ -458,11 +421,14 @@ void LCRQ::enqueue(int32_t arg, int tid){
 
 	newcrq.ptr=NULL;
 	while(true){ 
-		hazard[tid].ui=head_index; ; // get head_index, it is guaranteed to be 
+		reclaimer->begin(tid,head_index); // get head_index, it is guaranteed to be 
 								// less than or equal to the actual head and tail index
 								// we set it as our hazard index.  Nothing
 								// above it can be freed
 		crq.ui = tail.ui;
+		if(!reclaimer->stable(tid)){
+			continue;
+		}
 		if(crq.ptr->next!=NULL){
 			// tail wasn't actually the tail, try the next one and loop
 			crq_next.ptr = crq.ptr->next;
@@ -471,7 +437,7 @@ void LCRQ::enqueue(int32_t arg, int tid){
 			continue;
 		}
 		if(crqenqueue(crq.ptr,arg)==OK){ // successfully enqueued
-			hazard[tid].ui=UINT64_MAX; // reset our hazard index
+			reclaimer->end(tid); // reset our hazard index
 			if(newcrq.ptr!=NULL){
 				bp->free(newcrq.ptr,tid);
 			} 
@@ -488,6 +454,7 @@ void LCRQ::enqueue(int32_t arg, int tid){
 				abort();
 			}
 			initRingQueue(newcrq.ptr,0);
+			reclaimer->onAlloc(newcrq.ptr,tid);
 			if(crqenqueue(newcrq.ptr, arg)!=OK){
 				bp->free(newcrq.ptr,tid);
 				//puts("b");
@@ -499,7 +466,7 @@ void LCRQ::enqueue(int32_t arg, int tid){
 		newcrq.cntr = crq.cntr+1; // TODO: write after write issue?
 		if(__sync_bool_compare_and_swap (&(crq.ptr->next), NULL,newcrq.ptr)){//add new tail to list
 			__sync_bool_compare_and_swap (&tail.ui, crq.ui,newcrq.ui); // update tail pointer
-			hazard[tid].ui=UINT64_MAX; // reset our hazard index
+			reclaimer->end(tid); // reset our hazard index
 			return;
 			//return (int32_t)newcrq.ptr;
 		}
@@ -31,6 +31,8 @@ limitations under the License.
 #include "ConcurrentPrimitives.hpp"
 #include "BlockPool.hpp"
 #include "RContainer.hpp"
+#include "ThreadRegistry.hpp"
+#include "Reclaimer.hpp"
 
 #define RING_SIZE 2048
 #define STARVATION 2
@@ -144,7 +146,10 @@ struct CRQ{
 	char pad3[LEVEL1_DCACHE_LINESIZE-sizeof(struct CRQ*)]; // padding to cache line size
 
 	uint64_t index;
-	char pad4[LEVEL1_DCACHE_LINESIZE-sizeof(uint64_t)]; // padding to cache line size
+	struct CRQ* retired_next; // reclamation bookkeeping, see Reclaimer.hpp
+	uint64_t birth_era;
+	uint64_t retire_era;
+	char pad4[LEVEL1_DCACHE_LINESIZE-3*sizeof(uint64_t)-sizeof(struct CRQ*)]; // padding to cache line size
 
 	struct Node ring[RING_SIZE];		//ring: array of nodes, initially node (1,u,null)
 };
@@ -177,28 +182,28 @@ void initRingQueue(struct CRQ* crq,uint64_t index);
 void inline initNode(struct Node* n, uint32_t safe_closed, uint32_t idx, uint32_t val);
 int32_t crqdequeue(struct CRQ* crq);
 int32_t crqenqueue(struct CRQ* crq, int32_t arg);
+bool seal(struct CRQ* crq);
 
 // linked circular ring queue
-class LCRQ: public virtual RQueue, public Reportable{
+class LCRQ: public virtual RQueue, public Reportable, public SlotOwner{
 public:
 	CRQ_ptr head; // the head CRQ in the linked list
 	CRQ_ptr tail; // the tail CRQ in the linked list
 
 	volatile uint64_t head_index; // TODO: deal with atomic reads
-	struct volatile_padded<uint64_t>* hazard;
-	struct volatile_padded<std::list<struct CRQ*>*>* retired;
+	Reclaimer<struct CRQ>* reclaimer;
 	int task_num;
 	BlockPool<struct CRQ>* bp;
 
 //public:
 	LCRQ(int task_num);
-	LCRQ(int task_num, bool glibc_mem);
+	LCRQ(int task_num, bool glibc_mem, ReclaimerConfig rc=ReclaimerConfig());
 	~LCRQ();
 
 	int32_t dequeue(int tid);
 	void enqueue(int32_t arg, int tid);
 	int32_t verify();
-	void retire(int tid, struct CRQ* crq);
+	void releaseSlot(int tid);
 
 	void conclude(){
 		int i = 0;
@@ -206,6 +211,9 @@ public:
 			i++;
 		}
 		std::cout<<"size@End="<<i<<std::endl;
+		std::cout<<"reclaim="<<reclaimer->name()<<" batch="<<reclaimer->getBatch()
+		  <<" retired@Peak="<<reclaimer->retiredPeak()
+		  <<" ("<<reclaimer->retiredPeak()*sizeof(struct CRQ)/1024<<"KB)"<<std::endl;
 	}
 
 };
@@ -213,7 +221,7 @@ public:
 
 class LCRQFactory : public RContainerFactory{
 	LCRQ* build(GlobalTestConfig* gtc){
-		return new LCRQ(gtc->task_num,gtc->environment["glibc"]=="1");
+		return new LCRQ(gtc->task_num,gtc->environment["glibc"]=="1",ReclaimerConfig(gtc));
 	}
 };
 
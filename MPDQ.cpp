@@ -45,6 +45,13 @@ void initDRQ(DRQ* drq, uint64_t index){
 	drq->next=NULL;
 	drq->abandoned=0;
 	drq->index=index;
+	#ifdef RING_TELEMETRY
+	drq->t_data=0;
+	drq->t_antidata=0;
+	drq->t_mixed=0;
+	drq->t_closed_full=false;
+	drq->t_head_start=0;
+	#endif
 	for(i=0;i<DRQ_RING_SIZE;i++){
 		initDRQNode(&drq->ring[i],1,i,NULL_VAL,DATA);
 	}
@@ -186,6 +193,7 @@ int32_t _drqdenqueue(DRQ* drq, int32_t arg, bool polarity){
 					initDRQNode(&emptynode,safe,p.idx+R,NULL_VAL,antidata);
 					if(__sync_bool_compare_and_swap (&(node->ui), localnodecopy.ui, emptynode.ui)){
 						//puts("mix");		
+						TELEMETRY(__sync_fetch_and_add(&drq->t_mixed,1));
 						return mix(arg,val,polarity,node);
 					}
 				}	
@@ -212,6 +220,7 @@ int32_t _drqdenqueue(DRQ* drq, int32_t arg, bool polarity){
 					if(polarity==ANTIDATA){w->set((uint32_t)node,false);}
 					if(__sync_bool_compare_and_swap (&(node->ui), localnodecopy.ui, newnode.ui)){  
 						//puts("enqueued");	
+						TELEMETRY(__sync_fetch_and_add(polarity==DATA?&drq->t_data:&drq->t_antidata,1));
 						return finishedenqueue(arg,polarity);
 					}
 				}
@@ -224,6 +233,7 @@ int32_t _drqdenqueue(DRQ* drq, int32_t arg, bool polarity){
 		// if fail to make progress
 		op_idx.ui = op->ui;
 		if( ( (((int)p.idx-op_idx.idx)>=R) || starvationLevel>DRQ_STARVATION) && !p.closed){
+			TELEMETRY(drq->t_closed_full = true);
 			if(polarity==DATA){
 				drq->data_idx.close();
 			}
@@ -288,6 +298,7 @@ int32_t _drqdenqueue_lockfree(DRQ* drq, int32_t arg, bool polarity){
 		}
 		// if fail to make progress
 		if( ( (((int)drq->data_idx.idx-(int)op->idx)>=(R-2*48)) || starvationLevel>DRQ_STARVATION) && !p.closed){
+			TELEMETRY(drq->t_closed_full = true);
 			drq->data_idx.close();
 			closeIdx = discovered_closing(drq,drq->data_idx.idx,polarity);
 			assert(drq->closedInfo.closed==1);
@@ -337,6 +348,7 @@ int32_t _drqdenqueue_lockfree(DRQ* drq, int32_t arg, bool polarity){
 				//__sync_synchronize();
 				if(((drq_wait*)val)->satisfy((int32_t)node,arg)){
 					//printf("Won @ %x\n",(drq_wait*)val);
+					TELEMETRY(__sync_fetch_and_add(&drq->t_mixed,1));
 					__sync_bool_compare_and_swap (&(node->ui), localnodecopy.ui, emptynode.ui);
 					return OK;
 				}
@@ -362,6 +374,7 @@ int32_t _drqdenqueue_lockfree(DRQ* drq, int32_t arg, bool polarity){
 				initDRQNode(&newnode,1,p.idx,arg,polarity);
 				if(__sync_bool_compare_and_swap (&(node->ui), localnodecopy.ui, newnode.ui)){  
 					//printf("enqueued %d@%d\n",arg,p.idx);	
+					TELEMETRY(__sync_fetch_and_add(&drq->t_data,1));
 					return finishedenqueue(arg,polarity);
 				}
 			}
@@ -412,11 +425,14 @@ int32_t MPDQ::denqueue(int32_t arg, bool polarity, int tid){
 
 
 	while(true){
-		hazard[tid].ui= head_index; // get head_index, it is guaranteed to be 
+		reclaimer->begin(tid,head_index); // get head_index, it is guaranteed to be 
 								// less than or equal to the actual head index
 								// we set it as our hazard index.  Nothing
 								// above it can be freed
 		drq = *head;
+		if(!reclaimer->stable(tid)){
+			continue;
+		}
 
 		if(polarity==DATA && lock_free){
 			v = _drqdenqueue_lockfree(drq.ptr,arg,polarity);
@@ -427,7 +443,7 @@ int32_t MPDQ::denqueue(int32_t arg, bool polarity, int tid){
 		
 		// successful dequeue
 		if(v!=CLOSED && v!=DRQ_EMPTY){
-			hazard[tid].ui=UINT64_MAX; // reset our hazard index
+			reclaimer->end(tid); // reset our hazard index
 			//if(arg==1000 && v==OK){
 			//	this->hotdrq = drq.ptr;
 			//}
@@ -441,7 +457,9 @@ int32_t MPDQ::denqueue(int32_t arg, bool polarity, int tid){
 			if(drq.ptr->next!=NULL){
 				drq_next.ptr = drq.ptr->next;
 				drq_next.cntr = drq.cntr+1;
-				__sync_bool_compare_and_swap (&head->ui, drq.ui,drq_next.ui); 
+				if(__sync_bool_compare_and_swap (&head->ui, drq.ui,drq_next.ui)){
+					TELEMETRY(__sync_bool_compare_and_swap(&drq_next.ptr->t_head_start,0,RingTelemetry::usec()));
+				}
 			}
 			else{
 				// if not, add it
@@ -452,11 +470,14 @@ int32_t MPDQ::denqueue(int32_t arg, bool polarity, int tid){
 						abort();
 					}
 					initDRQ(newdrq.ptr,0);
+					reclaimer->onAlloc(newdrq.ptr,tid);
 				}
 				newdrq.ptr->index = drq.ptr->index+1;
 				newdrq.cntr = drq.cntr+1;
 				if(__sync_bool_compare_and_swap (&(drq.ptr->next), NULL,newdrq.ptr)){//add new tail to list
-					__sync_bool_compare_and_swap (&head->ui, drq.ui,newdrq.ui); // update head pointer
+					if(__sync_bool_compare_and_swap (&head->ui, drq.ui,newdrq.ui)){ // update head pointer
+						TELEMETRY(__sync_bool_compare_and_swap(&newdrq.ptr->t_head_start,0,RingTelemetry::usec()));
+					}
 					newdrq.ptr=NULL;
 				}
 				else{
@@ -470,8 +491,9 @@ int32_t MPDQ::denqueue(int32_t arg, bool polarity, int tid){
 		if(v==DRQ_EMPTY){
 			if(__sync_bool_compare_and_swap(&(drq.ptr->abandoned), 0,1)){ 
 				__sync_fetch_and_add (&head_index, 1);  // update head index
-				hazard[tid].ui=UINT64_MAX; // this line breaks things (does it still?)
-				retire(tid,drq.ptr);
+				reclaimer->end(tid); // this line breaks things (does it still?)
+				TELEMETRY(drq.ptr->report(telemetry,false,tid));
+				reclaimer->retire(drq.ptr,tid);
 			}
 		}
 	}
@@ -487,26 +509,28 @@ int32_t MPDQ::remove(int tid){
 }
 
 
-MPDQ::MPDQ(int t_num, bool glibc_mem,bool lock_free){
+MPDQ::MPDQ(int t_num, bool glibc_mem,bool lock_free, ReclaimerConfig rc){
 	
 	int i,j;
 	this->lock_free = lock_free;
 	// init block pool
 	bp = new BlockPool<DRQ>(t_num,glibc_mem);
 	std::list<DRQ*> v;
+	reclaimer = buildReclaimer<DRQ>(rc,t_num,bp);
 	data_head.ptr = (DRQ*)bp->alloc(0); //(malloc(sizeof(DRQ));
 	data_head.cntr=0;
 	initDRQ(data_head.ptr,0);
+	reclaimer->onAlloc(data_head.ptr,0);
 	head_index = 0;
 	antidata_head=data_head;
 	antidata_head.cntr = 0;
-	hazard = new volatile_padded<uint64_t>[t_num];
+	#ifdef RING_TELEMETRY
+	telemetry = new RingTelemetry(t_num);
+	data_head.ptr->t_head_start = RingTelemetry::usec();
+	#endif
 	task_num = t_num;
-	retired = new volatile_padded<std::list<DRQ*>*>[t_num];
 	waiters = new padded<drq_wait>[t_num];
 	for(i=0;i<task_num;i++){
-		retired[i].ui=new std::list<DRQ*>();
-		hazard[i].ui=UINT64_MAX;
 		waiters[i].ui.set(0,1);
 	}
 
@@ -518,58 +542,48 @@ MPDQ::~MPDQ(){
 	DRQ* garbage;
 	DRQ* next_drq;
 
-	delete[] retired;
-	delete[] hazard;
+	delete reclaimer;
+	#ifdef RING_TELEMETRY
+	delete telemetry;
+	#endif
 }
 
-void MPDQ::retire(int tid, DRQ* drq){
-	int i;
-	uint64_t min_hazard;
-	min_hazard = UINT64_MAX;
-	long idx;
-	DRQ old;
-	DRQ* garbage;
-	old = *drq;
-	for(i=0;i<task_num;i++){
-		if(hazard[i].ui<min_hazard){
-			min_hazard=hazard[i].ui;
-		}
-	}
-
-	if(min_hazard>drq->index){
-		// drq is already clear,
-		// we can free it
-		bp->free(drq,tid);
-	}
-	else{
-		// drq is not clear
-		// append it to the retired list
-		retired[tid].ui->push_back(drq);
-		
-	}
-
-	// while we're here, lets empty our retired list
-	// anything on our list is unique,
-	// since it got there by us successfully removing it from
-	// the head pointer
-	while(retired[tid].ui->size()>0 && (*retired[tid].ui->begin())->index<min_hazard){
-
-		garbage = *retired[tid].ui->begin();
-		idx = garbage->index;
-		retired[tid].ui->pop_front(); 
-		bp->free(garbage,tid);
+#ifdef RING_TELEMETRY
+// record this ring's life in tid's telemetry buffer.
+// called by the thread that abandons the ring,
+// or at conclude() for rings still in the list
+void DRQ::report(RingTelemetry* tel, bool live, int tid){
+	RingRecord r;
+	r.index = index;
+	r.antidata = t_antidata>t_data;
+	r.data = t_data;
+	r.antidata_elems = t_antidata;
+	r.mixed = t_mixed;
+	r.close_idx = closedInfo.closed?closedInfo.idx:0;
+	r.head_usec = t_head_start==0?0:RingTelemetry::usec()-t_head_start;
+	r.closed_full = t_closed_full;
+	r.sealed_empty = abandoned;
+	r.live = live;
+	r.fixstates = 0;
+	r.emptychecks = 0;
+	tel->record(r,tid);
+}
+#endif
+
+void MPDQ::conclude(){
+	#ifdef RING_TELEMETRY
+	DRQ* d = data_head.ptr;
+	if(antidata_head.ptr->index<d->index){d = antidata_head.ptr;}
+	for(; d!=NULL; d = d->next){
+		d->report(telemetry,true,0);
 	}
-
+	telemetry->dump("MPDQ");
+	#endif
+	std::cout<<"reclaim="<<reclaimer->name()<<" batch="<<reclaimer->getBatch()
+	  <<" retired@Peak="<<reclaimer->retiredPeak()
+	  <<" ("<<reclaimer->retiredPeak()*sizeof(DRQ)/1024<<"KB)"<<std::endl;
 }
 
-
-
-
-
-
-
-
-
-
-
-
+void MPDQ::releaseSlot(int tid){
+	reclaimer->releaseSlot(tid);
+}
@@ -30,6 +30,9 @@ limitations under the License.
 #include <list>
 #include "RDualContainer.hpp"
 #include "BlockPool.hpp"
+#include "RingTelemetry.hpp"
+#include "ThreadRegistry.hpp"
+#include "Reclaimer.hpp"
 #include <atomic>
 
 #define DRQ_RING_SIZE 2048 
@@ -179,12 +182,24 @@ public:
 	char pad4[LEVEL1_DCACHE_LINESIZE-sizeof(struct DRQ*)]; // padding to cache line size
 
 	uint64_t index;
-	char pad5[LEVEL1_DCACHE_LINESIZE-sizeof(uint64_t)]; // padding to cache line size
+	struct DRQ* retired_next; // reclamation bookkeeping, see Reclaimer.hpp
+	uint64_t birth_era;
+	uint64_t retire_era;
+	char pad5[LEVEL1_DCACHE_LINESIZE-3*sizeof(uint64_t)-sizeof(struct DRQ*)]; // padding to cache line size
 
 	uint32_t abandoned;
 	char pad6[LEVEL1_DCACHE_LINESIZE-sizeof(uint32_t)]; // padding to cache line size
 
 	drq_node ring[DRQ_RING_SIZE];		//ring: array of nodes, initially node (1,u,null)
+
+	#ifdef RING_TELEMETRY
+	uint32_t t_data;
+	uint32_t t_antidata;
+	uint32_t t_mixed;
+	bool t_closed_full;
+	uint64_t t_head_start;
+	void report(RingTelemetry* tel, bool live, int tid);
+	#endif
 };
 
 class DRQ_ptr{
@@ -227,7 +242,7 @@ int32_t drqdenqueue(DRQ* drq, int32_t arg, bool polarity);
 
 
 // linked circular ring queue
-class MPDQ: public RDualContainer{
+class MPDQ: public RDualContainer, public Reportable, public SlotOwner{
 public:
 	DRQ_ptr data_head; // the head CRQ in the linked list
 	DRQ_ptr antidata_head; // the tail CRQ in the linked list
@@ -237,18 +252,22 @@ public:
 	padded<drq_wait>* waiters;
 
 	volatile uint64_t head_index;
-	volatile_padded<uint64_t>* hazard;
-	volatile_padded<std::list<struct DRQ*>*>* retired;
+	Reclaimer<DRQ>* reclaimer;
 	int task_num;
 	BlockPool<DRQ>* bp;
+	#ifdef RING_TELEMETRY
+	RingTelemetry* telemetry;
+	#endif
 	int32_t denqueue(int32_t arg, bool polarity, int tid);
-	void retire(int tid, struct DRQ* crq);
+	void releaseSlot(int tid);
 
 
 //public:
-	MPDQ(int task_num, bool glibc_mem, bool lock_free);
+	MPDQ(int task_num, bool glibc_mem, bool lock_free, ReclaimerConfig rc=ReclaimerConfig());
 	~MPDQ();
 
+	void conclude();
+
 	
 	int32_t remove(int tid);
 	void insert(int32_t arg, int tid);
@@ -266,7 +285,7 @@ public:
 	}
 
 	MPDQ* build(GlobalTestConfig* gtc){
-		return new MPDQ(gtc->task_num, gtc->environment["glibc"]=="1",nonblocking);
+		return new MPDQ(gtc->task_num, gtc->environment["glibc"]=="1",nonblocking,ReclaimerConfig(gtc));
 	}
 
 };
@@ -30,15 +30,25 @@ limitations under the License.
 // local headers
 #include "Tests.hpp"
 #include "TreiberStack.hpp"
+#include "EliminationStack.hpp"
+#include "SkipListPriorityQueue.hpp"
+#include "MultiQueue.hpp"
+#include "SplitOrderedMap.hpp"
+#include "KeyedDual.hpp"
+#include "OptimisticQueue.hpp"
+#include "BasketsQueue.hpp"
 #include "MSQueue.hpp"
 #include "MichaelOrderedSet.hpp"
 #include "GenericDual.hpp"
 #include "LCRQ.hpp"
 #include "Trivial.hpp"
 #include "FCDualQueue.hpp"
+#include "CCSynchDualQueue.hpp"
 #include "SSDualQueue.hpp"
 #include "MPDQ.hpp"
 #include "SPDQ.hpp"
+#include "ShmLCRQ.hpp"
+#include "ShmSPDQ.hpp"
 
 using namespace std;
 
@@ -72,27 +82,86 @@ int main(int argc, char *argv[])
 	//gtc->addRideableOption(new TrivialFactory(), "Trivial");
 	//gtc->addRideableOption(new GenericDualFactory(new TreiberStackFactory(), new TreiberStackFactory(),false), "GenericDual (TS:TS)");
 	gtc->addRideableOption(new FCDualQueueFactory(), "FCDualQueue");
+	gtc->addRideableOption(new CCSynchDualQueueFactory(false), "CCSynchDualQueue");
+	gtc->addRideableOption(new CCSynchDualQueueFactory(true), "HSynchDualQueue");
 	gtc->addRideableOption(new SSDualQueueFactory(), "SSDualQueue");
 	gtc->addRideableOption(new MPDQFactory(false), "MPDQ Blocking");
 	gtc->addRideableOption(new MPDQFactory(true), "MPDQ Nonblocking");
 	gtc->addRideableOption(new SPDQFactory(false), "SPDQ Blocking");
 	gtc->addRideableOption(new SPDQFactory(true), "SPDQ Nonblocking");
+	gtc->addRideableOption(new ShmLCRQFactory(), "ShmLCRQ (shared segment)");
+	gtc->addRideableOption(new ShmSPDQFactory(), "ShmSPDQ Blocking (shared segment)");
 
 	gtc->addRideableOption(new GenericDualFactory(new LCRQFactory(), 
 	  new LCRQFactory(),false), "GenericDual (LCRQ:LCRQ)");
 
+	gtc->addRideableOption(new EliminationStackFactory(), "Elimination Stack");
+	gtc->addRideableOption(new GenericDualFactory(new LCRQFactory(), new EliminationStackFactory(),false), "GenericDual (LCRQ:EStack)");
+	gtc->addRideableOption(new GenericDualFactory(new LCRQFactory(), new EliminationStackFactory(),true), "GenericDualNB (LCRQ:EStack)");
+
+	gtc->addRideableOption(new SkipListPriorityQueueFactory(), "SkipList PriorityQueue");
+	gtc->addRideableOption(new GenericDualFactory(new LCRQFactory(), 
+	  new SkipListPriorityQueueFactory(),false), "GenericDual (LCRQ:SkipPQ)");
+	gtc->addRideableOption(new GenericDualFactory(new LCRQFactory(), 
+	  new SkipListPriorityQueueFactory(),true), "GenericDualNB (LCRQ:SkipPQ)");
+
+	gtc->addRideableOption(new MultiQueueFactory(), "MultiQueue");
+	gtc->addRideableOption(new GenericDualFactory(new LCRQFactory(), 
+	  new MultiQueueFactory(),false), "GenericDual (LCRQ:MultiQ)");
+	gtc->addRideableOption(new GenericDualFactory(new LCRQFactory(), 
+	  new MultiQueueFactory(),true), "GenericDualNB (LCRQ:MultiQ)");
+
+	gtc->addRideableOption(new MichaelOrderedMapFactory(), "MH OrderedMap");
+	gtc->addRideableOption(new SplitOrderedMapFactory(), "SplitOrdered HashMap");
+
+	gtc->addRideableOption(new KeyedDualFactory(false), "KeyedDual (MHOL)");
+	gtc->addRideableOption(new KeyedDualFactory(true), "KeyedDual (SplitOrdered)");
+
+	gtc->addRideableOption(new OptimisticQueueFactory(), "Optimistic Queue");
+	gtc->addRideableOption(new BasketsQueueFactory(), "Baskets Queue");
+	gtc->addRideableOption(new GenericDualFactory(new LCRQFactory(), new OptimisticQueueFactory(),false), "GenericDual (LCRQ:OptQ)");
+	gtc->addRideableOption(new GenericDualFactory(new LCRQFactory(), new BasketsQueueFactory(),false), "GenericDual (LCRQ:BasketsQ)");
+	gtc->addRideableOption(new GenericDualFactory(new LCRQFactory(), new OptimisticQueueFactory(),true), "GenericDualNB (LCRQ:OptQ)");
+	gtc->addRideableOption(new GenericDualFactory(new LCRQFactory(), new BasketsQueueFactory(),true), "GenericDualNB (LCRQ:BasketsQ)");
+
 
 	gtc->addTestOption(new FAITest(), "FAI Test");
 	gtc->addTestOption(new PotatoTest(0), "PotatoTest(0 ms delay)");
 	gtc->addTestOption(new PotatoTest(1), "PotatoTest(1 ms delay)");
 	gtc->addTestOption(new PotatoTest(2), "PotatoTest(2 ms delay)");
 	gtc->addTestOption(new InsertRemoveTest(), "InsertRemoveTest");
+	gtc->addTestOption(new RegistryChurnTest(), "RegistryChurnTest");
+	gtc->addTestOption(new RingChurnTest(), "RingChurnTest");
+	gtc->addTestOption(new SparseActiveTest(2), "SparseActiveTest(2 active)");
+	gtc->addTestOption(new OpLatencyTest(), "OpLatencyTest");
+	gtc->addTestOption(new ConsumerHeavyTest(1), "ConsumerHeavyTest(1 producer)");
+	gtc->addTestOption(new PingPongTest(), "PingPongTest");
+	gtc->addTestOption(new BatchStackTest(1), "BatchStackTest(1 per batch)");
+	gtc->addTestOption(new BatchStackTest(8), "BatchStackTest(8 per batch)");
+	gtc->addTestOption(new BatchStackTest(64), "BatchStackTest(64 per batch)");
+	gtc->addTestOption(new DeepQueueTest(1000), "DeepQueueTest(1K deep)");
+	gtc->addTestOption(new DeepQueueTest(32768), "DeepQueueTest(32K deep)");
+	gtc->addTestOption(new DeepQueueTest(1000000), "DeepQueueTest(1M deep)");
+	gtc->addTestOption(new RankErrorTest(1000), "RankErrorTest(1K deep)");
+	gtc->addTestOption(new ForkJoinTest(20), "ForkJoinTest(fib 20)");
+	gtc->addTestOption(new FanOutTest(64), "FanOutTest(64 wide)");
 	//gtc->addTestOption(new QueueVerificationTest(), "QueueVerification Test");
 	//gtc->addTestOption(new StackVerificationTest(), "StackVerification Test");
 	gtc->addTestOption(new NothingTest(), "Nothing Test");
 	//gtc->addTestOption(new MarkedPtrTest(), "MarkedPtrTest");
-	//gtc->addTestOption(new MapUnmapTest(), "MapUnmapTest");
-	//gtc->addTestOption(new MapVerificationTest(), "MapVerificationTest");
+	gtc->addTestOption(new BatchRemoveTest(1), "BatchRemoveTest(1 per batch)");
+	gtc->addTestOption(new BatchRemoveTest(8), "BatchRemoveTest(8 per batch)");
+	gtc->addTestOption(new BatchRemoveTest(64), "BatchRemoveTest(64 per batch)");
+	gtc->addTestOption(new PayloadTest(false), "PayloadTest(32 bit)");
+	gtc->addTestOption(new PayloadTest(true), "PayloadTest(64 bit)");
+	gtc->addTestOption(new MessageTest(64), "MessageTest(64 B)");
+	gtc->addTestOption(new MessageTest(4096), "MessageTest(4 KiB)");
+	gtc->addTestOption(new MessageTest(65536), "MessageTest(64 KiB)");
+	gtc->addTestOption(new MessageTest(65536,true), "MessageTest(64 KiB, copied)");
+	gtc->addTestOption(new MapMixTest(90), "MapMixTest(90% lookups)");
+	gtc->addTestOption(new MapMixTest(10), "MapMixTest(10% lookups)");
+	gtc->addTestOption(new KeyedRendezvousTest(100000,0), "KeyedRendezvousTest(100K keys, uniform)");
+	gtc->addTestOption(new KeyedRendezvousTest(100000,0.99), "KeyedRendezvousTest(100K keys, zipf 0.99)");
 
 	try{
 		gtc->parseCommandLine(argc,argv);
@@ -0,0 +1,197 @@
+/*
+
+Copyright 2015 University of Rochester
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+
+
+
+
+
+#ifndef MESSAGE_ARENA_HPP
+#define MESSAGE_ARENA_HPP
+
+#ifndef _REENTRANT
+#define _REENTRANT		/* basic 3-lines for threads */
+#endif
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <atomic>
+#include "ConcurrentPrimitives.hpp"
+#include "RDualContainer.hpp"
+
+#define MSG_MIN_CLASS 6 // 64 B blocks
+#define MSG_MAX_CLASS 17 // 128 KiB blocks
+#define MSG_CLASSES (MSG_MAX_CLASS-MSG_MIN_CLASS+1)
+
+
+// Messages written and read in place, passed through any
+// container as 32 bit handles instead of being copied into
+// side buffers.  A producer allocates a block, builds the
+// message in data(h) and inserts h; the consumer removes h,
+// reads data(h) and releases it.
+//
+// Each thread allocates from its own slice of one reservation,
+// in power of two size classes with a 16 byte header per block.
+// A block is only ever reused by the thread that carved it:
+// released by its owner it goes on the owner's private free
+// list, released by anyone else it is pushed on the owner's
+// remote stack for that class, which the owner takes whole
+// with one exchange when its private list runs dry, so there
+// is no ABA.  Slices are untouched until their owner carves
+// them, which places them on the owner's node under Linux's
+// first touch policy; no libnuma.
+//
+// A handle is the block's offset in 64 byte units, plus one so
+// 0 stays EMPTY.
+class MessageArena{
+	struct Block{
+		int32_t next; // handle, on a free list
+		uint16_t owner;
+		uint8_t cls;
+		uint8_t pad[9];
+	};
+
+	struct Slab{
+		char* bump;
+		char* end;
+		int32_t local[MSG_CLASSES]; // private free lists
+		int64_t remoteFrees;
+	};
+
+	char* base;
+	size_t slice;
+	size_t bytes; // whole mapping, slice*task_num
+	int task_num;
+	padded<Slab>* slabs;
+	// remote[tid*MSG_CLASSES+cls], each on its own line
+	padded<std::atomic<int32_t>>* remote;
+
+	inline Block* block(int32_t h){
+		return (Block*)(base+((size_t)(h-1)<<MSG_MIN_CLASS));
+	}
+	inline int32_t handle(Block* b){
+		return (int32_t)(((char*)b-base)>>MSG_MIN_CLASS)+1;
+	}
+
+public:
+	static const int HEADER = sizeof(Block);
+	static const int MAX_MESSAGE = (1<<MSG_MAX_CLASS)-sizeof(Block);
+
+	// reserves sliceBytes of address space per thread; only
+	// pages that are carved into blocks are ever touched
+	MessageArena(int task_num, size_t sliceBytes){
+		this->task_num = task_num;
+		// in 64 bits, since size_t is 32 under -m32 and would wrap
+		uint64_t s = ((uint64_t)sliceBytes+(1<<MSG_MAX_CLASS)-1)&~(uint64_t)((1<<MSG_MAX_CLASS)-1);
+		uint64_t total = s*(uint64_t)task_num;
+		if((total>>MSG_MIN_CLASS)>=0x7fffffff){
+			errexit("MessageArena too large for 32 bit handles.");
+		}
+		if((uint64_t)(size_t)total!=total){
+			errexit("MessageArena too large for the address space.");
+		}
+		slice = (size_t)s;
+		bytes = (size_t)total;
+		base = (char*)mmap(NULL,bytes,PROT_READ|PROT_WRITE,
+		  MAP_PRIVATE|MAP_ANONYMOUS|MAP_NORESERVE,-1,0);
+		if(base==MAP_FAILED){
+			perror("mmap");
+			abort();
+		}
+		slabs = new padded<Slab>[task_num];
+		remote = new padded<std::atomic<int32_t>>[task_num*MSG_CLASSES];
+		for(int i = 0; i<task_num; i++){
+			slabs[i].ui.bump = base+slice*i;
+			slabs[i].ui.end = base+slice*(i+1);
+			slabs[i].ui.remoteFrees = 0;
+			for(int c = 0; c<MSG_CLASSES; c++){
+				slabs[i].ui.local[c] = 0;
+				remote[i*MSG_CLASSES+c].ui.store(0);
+			}
+		}
+	}
+	~MessageArena(){
+		munmap(base,bytes);
+		delete[] slabs;
+		delete[] remote;
+	}
+
+	// a block with room for size bytes, owned by tid
+	int32_t alloc(int size, int tid){
+		int cls = MSG_MIN_CLASS;
+		while((1<<cls)<size+HEADER){
+			cls++;
+		}
+		if(cls>MSG_MAX_CLASS){
+			errexit("MessageArena message too large.");
+		}
+		Slab& s = slabs[tid].ui;
+		int c = cls-MSG_MIN_CLASS;
+		int32_t h = s.local[c];
+		if(h==0){
+			// reclaim everything other threads have released
+			h = remote[tid*MSG_CLASSES+c].ui.exchange(0,std::memory_order_acquire);
+		}
+		Block* b;
+		if(h!=0){
+			b = block(h);
+			s.local[c] = b->next;
+			return h;
+		}
+		// carve a new block, aligned to its size
+		char* p = (char*)(((uintptr_t)s.bump+(1<<cls)-1)&~(uintptr_t)((1<<cls)-1));
+		if(p+(1<<cls)>s.end){
+			errexit("MessageArena slice full; raise its size.");
+		}
+		s.bump = p+(1<<cls);
+		b = (Block*)p;
+		b->owner = tid;
+		b->cls = cls;
+		return handle(b);
+	}
+
+	inline void* data(int32_t h){
+		return (char*)block(h)+HEADER;
+	}
+	inline int capacity(int32_t h){
+		return (1<<block(h)->cls)-HEADER;
+	}
+
+	// hand h back to its owner; any thread, once per alloc
+	void release(int32_t h, int tid){
+		Block* b = block(h);
+		int c = b->cls-MSG_MIN_CLASS;
+		if(b->owner==tid){
+			b->next = slabs[tid].ui.local[c];
+			slabs[tid].ui.local[c] = h;
+			return;
+		}
+		std::atomic<int32_t>& r = remote[b->owner*MSG_CLASSES+c].ui;
+		int32_t old = r.load(std::memory_order_relaxed);
+		do{
+			b->next = old;
+		}while(!r.compare_exchange_weak(old,h,std::memory_order_release,std::memory_order_relaxed));
+		slabs[tid].ui.remoteFrees++;
+	}
+
+	int64_t remoteFrees(int tid){return slabs[tid].ui.remoteFrees;}
+};
+
+#endif
@@ -168,6 +168,114 @@ bool MichaelOrderedMap::removeMin_cond(uint64_t peekKey, int tid){
 	return true;
 }
 
+// Marks up to k nodes from the front, then unlinks them all
+// with one CAS on head.  A marked node's next can't be CAS'd,
+// so while head is unchanged every node we marked, and the
+// one after the last, is still linked; that check is what
+// makes each step's hazard good.  If expect is given, the
+// front must still be those nodes, by their predecessors'
+// next words, or we stop at the first that has changed.
+// A key inserted below the batch while we mark can be
+// overtaken, much like the head ABA in removeMin_cond.
+int MichaelOrderedMap::removeMin_prefix(int k, KeyVal* expect, int32_t* vals, int tid){
+	mptr_local<Node> oldptr;
+	mptr_local<Node> newptr;
+	mptr_local<Node> first;
+	mptr_local<Node> next;
+	Node* cur;
+	Node* after = NULL;
+	findInfo f;
+	int n = 0;
+
+	while(k>0){
+		f = findMin(tid);
+		if(!f.found){break;} // empty
+		if(expect!=NULL && f.cur.all()!=expect[0].key){break;}
+		first.init(false,f.cur.ptr(),f.cur.sn());
+		cur = f.cur.ptr();
+		next.init(f.next.all());
+
+		while(true){
+			// mark cur as deleted
+			int32_t val = cur->val;
+			oldptr.init(false,next.ptr(),next.sn());
+			newptr.init(true,next.ptr(),next.sn()+1);
+			if(!cur->next.CAS(oldptr,newptr)){break;}
+			if(vals!=NULL){vals[n] = val;}
+			n++;
+			after = next.ptr();
+			if(n==k || after==NULL){break;}
+			if(expect!=NULL && oldptr.all()!=expect[n].key){break;}
+
+			// step forward, alternating the two hazards
+			haz->reserve(after,(n+1)%2,tid);
+			if(head.all()!=first.all()){break;} // someone is unlinking
+			cur = after;
+			next.init(cur->next.all());
+			if(next.marked()){break;}
+		}
+		if(n>0 || expect!=NULL){break;}
+		// lost the first mark, retry
+	}
+
+	if(n>0){
+		// remove
+		newptr.init(false,after,first.sn()+1);
+		if(head.CAS(first,newptr)){
+			// nobody else could have unlinked any without moving head
+			cur = first.ptr();
+			while(cur!=after){
+				Node* t = cur->next.ptr();
+				haz->retire(cur,tid);
+				cur = t;
+			}
+		}
+		else{
+			findMin(tid); // clean up if necessary
+		}
+	}
+	haz->clearAll(tid);
+	return n;
+}
+
+int MichaelOrderedMap::removeMin_batch(int k, int32_t* vals, int tid){
+	return removeMin_prefix(k,NULL,vals,tid);
+}
+
+int MichaelOrderedMap::removeMin_cond_range(KeyVal* kvs, int n, int tid){
+	return removeMin_prefix(n,kvs,NULL,tid);
+}
+
+// the first key is peekMin's, the rest are the next
+// words of their predecessors, unmarked
+int MichaelOrderedMap::peekMin_range(int k, KeyVal* kvs, int tid){
+	findInfo f = findMin(tid);
+	mptr_local<Node> next;
+	Node* cur;
+	int n = 0;
+
+	if(f.cur.ptr()!=NULL && k>0){
+		kvs[0].key = f.cur.all();
+		kvs[0].val = f.cur.ptr()->val;
+		n = 1;
+		cur = f.cur.ptr();
+		next.init(f.next.all());
+		while(n<k && next.ptr()!=NULL){
+			haz->reserve(next.ptr(),(n+1)%2,tid);
+			// an unmarked cur is still linked
+			if(cur->next.all()!=next.all()){break;}
+			kvs[n].key = next.all();
+			kvs[n].val = next.ptr()->val;
+			n++;
+			cur = next.ptr();
+			next.init(cur->next.all());
+			if(next.marked()){break;}
+		}
+	}
+	haz->clearAll(tid);
+	return n;
+}
+
 bool MichaelOrderedMap::map(int key, int32_t val,int tid) {
 	assert(val!=0); // 0 used as EMPTY signal
 	assert(key!=0); // 0 used as EMPTY signal
@@ -288,6 +396,22 @@ KeyVal MichaelPriorityQueue::peek(int tid){
 bool MichaelPriorityQueue::remove_cond(uint64_t peekKey, int tid){
 	return map.removeMin_cond(peekKey, tid);
 }
+int MichaelPriorityQueue::remove_batch(int k, int32_t* vals, int tid){
+	int n = 0;
+	int m;
+	while(n<k){
+		m = map.removeMin_batch(k-n,vals+n,tid);
+		if(m==0){break;} // empty
+		n+=m;
+	}
+	return n;
+}
+int MichaelPriorityQueue::peek_range(int k, KeyVal* kvs, int tid){
+	return map.peekMin_range(k,kvs,tid);
+}
+int MichaelPriorityQueue::remove_cond_range(KeyVal* kvs, int n, int tid){
+	return map.removeMin_cond_range(kvs,n,tid);
+}
 
 
 int32_t MichaelOrderedSet::remove(int32_t e, int tid){
@@ -232,6 +232,7 @@ class MichaelOrderedMap : public RMap{
 	MichaelOrderedMap::findInfo find(int32_t key, bool findMin, int tid);
 	MichaelOrderedMap::findInfo find(int32_t key, int tid);
 	MichaelOrderedMap::findInfo findMin(int tid);
+	int removeMin_prefix(int k, KeyVal* expect, int32_t* vals, int tid);
 	void deleteNode(Node* ptr);
 
 
@@ -251,6 +252,13 @@ class MichaelOrderedMap : public RMap{
 	KeyVal peekMin(int tid);
 	bool removeMin_cond(uint64_t peekKey, int tid); 	
 
+	// Up to k minimums, marked in one pass from head and
+	// unlinked with one CAS on head.  removeMin_batch returns 0
+	// only when empty; both may stop short under contention.
+	int removeMin_batch(int k, int32_t* vals, int tid);
+	int peekMin_range(int k, KeyVal* kvs, int tid);
+	int removeMin_cond_range(KeyVal* kvs, int n, int tid);
+
 };
 
 
@@ -268,6 +276,9 @@ public:
 	int32_t remove(int tid);
 	KeyVal peek(int tid);
 	bool remove_cond(uint64_t key, int tid);
+	int remove_batch(int k, int32_t* vals, int tid);
+	int peek_range(int k, KeyVal* kvs, int tid);
+	int remove_cond_range(KeyVal* kvs, int n, int tid);
 
 };
 
@@ -0,0 +1,259 @@
+/*
+
+Copyright 2015 University of Rochester
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+
+
+// MultiQueue relaxed priority queue.
+//
+// See:
+//   H. Rihani, P. Sanders and R. Dementiev. MultiQueues: simple
+//   relaxed concurrent priority queues. SPAA 2015.
+// 
+
+
+#include <iostream>
+#include <stdlib.h>
+#include "RContainer.hpp"
+#include "MultiQueue.hpp"
+
+using namespace std;
+
+MultiQueue::MultiQueue(int task_num, int factor){
+	num_queues = factor*task_num;
+	if(num_queues<2){
+		num_queues = 2;
+	}
+	queues = new padded<Queue>[num_queues];
+	for(int i = 0; i<num_queues; i++){
+		Queue* q = &(queues[i].ui);
+		q->lock.store(false);
+		q->state.store((uint64_t)(uint32_t)EMPTY);
+		q->heap.cap = 1024;
+		q->heap.size = 0;
+		q->heap.a = (int32_t*)malloc(sizeof(int32_t)*q->heap.cap);
+	}
+	seeds = new padded<uint32_t>[task_num];
+	for(int i = 0; i<task_num; i++){
+		seeds[i].ui = i+1;
+	}
+}
+
+MultiQueue::~MultiQueue(){
+	for(int i = 0; i<num_queues; i++){
+		free(queues[i].ui.heap.a);
+	}
+	delete[] queues;
+	delete[] seeds;
+}
+
+void MultiQueue::conclude(){
+	cout<<"queues="<<num_queues<<endl;
+	int i = 0;
+	while(this->remove(0)!=EMPTY){
+		i++;
+	}
+	cout<<"size@End="<<i<<endl;
+}
+
+uint32_t MultiQueue::nextSeed(int tid){
+	uint32_t x = seeds[tid].ui;
+	x ^= x<<13;
+	x ^= x>>17;
+	x ^= x<<5;
+	seeds[tid].ui = x;
+	return x;
+}
+
+bool MultiQueue::tryLock(Queue* q){
+	return !q->lock.load(std::memory_order_relaxed)
+	  && !q->lock.exchange(true,std::memory_order_acquire);
+}
+
+void MultiQueue::lock(Queue* q){
+	while(!tryLock(q)){}
+}
+
+void MultiQueue::unlock(Queue* q){
+	q->lock.store(false,std::memory_order_release);
+}
+
+void MultiQueue::push(Queue* q, int32_t e){
+	Heap* h = &(q->heap);
+	if(h->size==h->cap){
+		h->cap*=2;
+		h->a = (int32_t*)realloc(h->a,sizeof(int32_t)*h->cap);
+	}
+	int i = h->size++;
+	while(i>0 && h->a[(i-1)/2]>e){
+		h->a[i] = h->a[(i-1)/2];
+		i = (i-1)/2;
+	}
+	h->a[i] = e;
+}
+
+int32_t MultiQueue::pop(Queue* q){
+	Heap* h = &(q->heap);
+	if(h->size==0){
+		return EMPTY;
+	}
+	int32_t top = h->a[0];
+	int32_t last = h->a[--h->size];
+	int i = 0;
+	int c;
+	while((c = 2*i+1)<h->size){
+		if(c+1<h->size && h->a[c+1]<h->a[c]){
+			c++;
+		}
+		if(h->a[c]>=last){
+			break;
+		}
+		h->a[i] = h->a[c];
+		i = c;
+	}
+	h->a[i] = last;
+	return top;
+}
+
+// call before unlocking; bumps the version
+void MultiQueue::publish(Queue* q){
+	uint32_t v = stateVersion(q->state.load(std::memory_order_relaxed))+1;
+	int32_t top = q->heap.size>0?q->heap.a[0]:EMPTY;
+	q->state.store(((uint64_t)v<<32)|(uint32_t)top);
+}
+
+// the sampled heap with the smaller minimum, -1 if both are empty
+int MultiQueue::pickTwo(int tid){
+	int i = nextSeed(tid)%num_queues;
+	int j = nextSeed(tid)%num_queues;
+	int32_t ti = stateTop(queues[i].ui.state.load());
+	int32_t tj = stateTop(queues[j].ui.state.load());
+	if(ti==EMPTY && tj==EMPTY){
+		return -1;
+	}
+	if(ti==EMPTY || (tj!=EMPTY && tj<ti)){
+		return j;
+	}
+	return i;
+}
+
+// Checks every heap in turn, waiting for locks, so EMPTY means
+// each one was seen empty after any insert that completed
+// before we started.
+int32_t MultiQueue::removeAny(int tid){
+	int start = nextSeed(tid)%num_queues;
+	for(int k = 0; k<num_queues; k++){
+		Queue* q = &(queues[(start+k)%num_queues].ui);
+		if(stateTop(q->state.load())==EMPTY){
+			continue;
+		}
+		lock(q);
+		int32_t v = pop(q);
+		if(v!=EMPTY){
+			publish(q);
+			unlock(q);
+			return v;
+		}
+		unlock(q);
+	}
+	return EMPTY;
+}
+
+void MultiQueue::insert(int32_t e, int tid){
+	Queue* q;
+	while(true){
+		q = &(queues[nextSeed(tid)%num_queues].ui);
+		if(tryLock(q)){
+			break;
+		}
+	}
+	push(q,e);
+	publish(q);
+	unlock(q);
+}
+
+int32_t MultiQueue::remove(int tid){
+	int i;
+	Queue* q;
+	int32_t v;
+	while(true){
+		i = pickTwo(tid);
+		if(i==-1){
+			return removeAny(tid);
+		}
+		q = &(queues[i].ui);
+		if(!tryLock(q)){
+			continue; // resample rather than wait
+		}
+		v = pop(q);
+		if(v!=EMPTY){
+			publish(q);
+			unlock(q);
+			return v;
+		}
+		unlock(q);
+	}
+}
+
+KeyVal MultiQueue::peek(int tid){
+	KeyVal kv;
+	uint64_t s;
+	int i;
+	while(true){
+		i = pickTwo(tid);
+		if(i==-1){
+			break;
+		}
+		s = queues[i].ui.state.load();
+		if(stateTop(s)!=EMPTY){ // else emptied since we sampled it
+			kv.key = ((uint64_t)stateVersion(s)<<32)|(uint32_t)(i+1);
+			kv.val = stateTop(s);
+			return kv;
+		}
+	}
+	// as in removeAny, only report EMPTY after seeing every heap empty
+	int start = nextSeed(tid)%num_queues;
+	for(int k = 0; k<num_queues; k++){
+		i = (start+k)%num_queues;
+		s = queues[i].ui.state.load();
+		if(stateTop(s)!=EMPTY){
+			kv.key = ((uint64_t)stateVersion(s)<<32)|(uint32_t)(i+1);
+			kv.val = stateTop(s);
+			return kv;
+		}
+	}
+	kv.key = 0;
+	kv.val = EMPTY;
+	return kv;
+}
+
+// pops the heap peek() chose if nothing has touched it since
+bool MultiQueue::remove_cond(uint64_t key, int tid){
+	Queue* q = &(queues[(uint32_t)key-1].ui);
+	uint32_t v = key>>32;
+	if(stateVersion(q->state.load())!=v){
+		return false; // precheck for failure
+	}
+	lock(q);
+	bool ret = stateVersion(q->state.load(std::memory_order_relaxed))==v;
+	if(ret){
+		pop(q);
+		publish(q);
+	}
+	unlock(q);
+	return ret;
+}
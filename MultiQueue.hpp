@@ -0,0 +1,105 @@
+/*
+
+Copyright 2015 University of Rochester
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+
+
+// MultiQueue relaxed priority queue.
+//
+// See:
+//   H. Rihani, P. Sanders and R. Dementiev. MultiQueues: simple
+//   relaxed concurrent priority queues. SPAA 2015.
+//
+// c*p sequential binary heaps, each behind its own try-lock.  An
+// insert pushes into a random heap it can lock; a remove samples
+// two heaps and pops the one whose minimum is smaller, so removes
+// spread over all the heaps instead of meeting at one head, at
+// the price of returning an element of small expected rank rather
+// than the minimum.  Each heap publishes its minimum beside a
+// version number in one word, so the sampling never takes a lock.
+//
+// Emptiness is not relaxed: when both samples are empty, remove
+// and peek go on to check every heap before reporting EMPTY,
+// which GenericDual relies on.  peek()'s key names a heap and
+// its version, and remove_cond() pops that heap only if it
+// hasn't changed since.
+//
+// c comes from -dmq_factor=c (default 2).
+
+
+#ifndef MULTI_QUEUE_H
+#define MULTI_QUEUE_H
+
+#include <atomic>
+#include <string>
+#include "RDualContainer.hpp"
+
+class MultiQueue : public virtual RPeekableContainer, public virtual RPriorityQueue, public Reportable{
+
+	// sequential min heap, only touched under its queue's lock
+	struct Heap{
+		int32_t* a;
+		int size;
+		int cap;
+	};
+
+	struct Queue{
+		std::atomic<bool> lock;
+		// version in the high half, the minimum (EMPTY
+		// when the heap is) in the low half
+		std::atomic<uint64_t> state;
+		Heap heap;
+	};
+
+	static inline int32_t stateTop(uint64_t s){return (int32_t)(s&0xffffffff);}
+	static inline uint32_t stateVersion(uint64_t s){return s>>32;}
+
+	padded<Queue>* queues;
+	int num_queues;
+	padded<uint32_t>* seeds;
+
+	uint32_t nextSeed(int tid);
+	bool tryLock(Queue* q);
+	void lock(Queue* q);
+	void unlock(Queue* q);
+	void push(Queue* q, int32_t e);
+	int32_t pop(Queue* q);
+	void publish(Queue* q);
+	int pickTwo(int tid);
+	int32_t removeAny(int tid);
+
+public:
+	MultiQueue(int task_num, int factor);
+	~MultiQueue();
+
+	void conclude();
+
+	void insert(int32_t e, int tid);
+	int32_t remove(int tid);
+	KeyVal peek(int tid);
+	bool remove_cond(uint64_t key, int tid);
+};
+
+class MultiQueueFactory : public RContainerFactory{
+	MultiQueue* build(GlobalTestConfig* gtc){
+		std::string c = gtc->environment["mq_factor"];
+		int factor = c.empty()?2:atoi(c.c_str());
+		return new MultiQueue(gtc->task_num,factor);
+	}
+};
+
+#endif
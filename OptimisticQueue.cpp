@@ -0,0 +1,183 @@
+/*
+
+Copyright 2015 University of Rochester
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+
+
+
+
+
+// Optimistic FIFO queue.
+//
+// See:
+//   E. Ladan-Mozes and N. Shavit. An optimistic approach to
+//   lock-free FIFO queues. DISC 2004.
+// 
+
+
+#include <list>
+#include <iostream>
+#include "RContainer.hpp"
+#include "OptimisticQueue.hpp"
+
+using namespace std;
+
+OptimisticQueue::OptimisticQueue(int task_num, bool glibc_mem){
+	this->task_num = task_num;
+	bp = new BlockPool<Node>(task_num,glibc_mem);
+	Node* dummy = bp->alloc(0);
+	dummy->next.init(NULL,0);
+	dummy->prev.init(NULL,0);
+	dummy->val = 0;
+	head.init(dummy,0);
+	tail.init(dummy,0);
+
+	fixes = new padded<int64_t>[task_num];
+	for(int i=0;i<task_num;i++){
+		fixes[i].ui = 0;
+	}
+
+	// preheat block pool
+	std::list<Node*> v;
+	for(int i=0;i<task_num;i++){
+		for(int j=0; j<2500; j++){
+			v.push_back(bp->alloc(i));
+		}
+	}
+	for(int i=0;i<task_num;i++){
+		for(int j=0; j<2500; j++){
+			bp->free(v.front(),i);
+			v.pop_front();
+		}
+	}
+}
+
+void OptimisticQueue::conclude(){
+	int64_t f = 0;
+	for(int i=0;i<task_num;i++){
+		f+=fixes[i].ui;
+	}
+	cout<<"fixes="<<f<<endl;
+}
+
+void OptimisticQueue::enqueue(int32_t val, int tid){
+	Node* node = bp->alloc(tid);
+	cptr_local<Node> my_tail;
+	node->val = val;
+	while(true){
+		my_tail.init(tail);
+		node->next.init(my_tail.ptr(),my_tail.sn()+1);
+		if(tail.CAS(my_tail,node)){
+			// the only CAS; until this store lands
+			// dequeues reach node through fixList
+			my_tail->prev.init(node,my_tail.sn());
+			break;
+		}
+	}
+}
+
+int32_t OptimisticQueue::dequeue(int tid){
+	cptr_local<Node> my_head, my_tail, first;
+	int32_t val;
+	while(true){
+		my_head.init(head);
+		my_tail.init(tail);
+		first.init(my_head->prev);
+		if(my_head.all()==head.all()){
+			// head, tail, and first are mutually consistent
+			if(my_tail.all()==my_head.all()){
+				return EMPTY;
+			}
+			if(first.sn()!=my_head.sn()){
+				// prev not set yet, or left over from the node's last life
+				fixList(my_tail,my_head,tid);
+				continue;
+			}
+			// Read value out of node before CAS. Otherwise another dequeue
+			// might free the next node.
+			val = first->val;
+			if(head.CAS(my_head,first.ptr())){
+				bp->free(my_head.ptr(),tid);
+				return val;
+			}
+		}
+	}
+}
+
+// walk the next links from tail to head, rewriting
+// each prev that doesn't point back with the right tag
+void OptimisticQueue::fixList(cptr_local<Node> my_tail, cptr_local<Node> my_head, int tid){
+	cptr_local<Node> cur, cur_next, next_prev;
+	fixes[tid].ui++;
+	cur.init(my_tail.all());
+	while(my_head.all()==head.all() && cur.all()!=my_head.all()){
+		cur_next.init(cur->next);
+		if(cur_next.sn()!=cur.sn()){return;} // cur was recycled under us
+		next_prev.init(cur_next->prev);
+		if(next_prev.ptr()!=cur.ptr() || next_prev.sn()!=cur.sn()-1){
+			cur_next->prev.init(cur.ptr(),cur.sn()-1);
+		}
+		cur.init(cur_next.ptr(),cur.sn()-1);
+	}
+}
+
+KeyVal OptimisticQueue::peek(int tid){
+	cptr_local<Node> my_head, my_tail, first;
+	KeyVal kv;
+	while(true){
+		my_head.init(head);
+		my_tail.init(tail);
+		first.init(my_head->prev);
+		if(my_head.all()==head.all()){
+			if(my_tail.all()==my_head.all()){
+				kv.key = 0;
+				kv.val = EMPTY;
+				return kv;
+			}
+			if(first.sn()!=my_head.sn()){
+				fixList(my_tail,my_head,tid);
+				continue;
+			}
+			kv.val = first->val;
+			// verify snapshot
+			if(my_head.all()==head.all()){
+				kv.key = my_head.all();
+				return kv;
+			}
+		}
+	}
+}
+
+bool OptimisticQueue::remove_cond(uint64_t key, int tid){
+	cptr_local<Node> my_head, my_tail, first;
+	while(true){
+		my_head.init(head);
+		if(my_head.all()!=key){return false;}
+		my_tail.init(tail);
+		first.init(my_head->prev);
+		if(my_tail.all()==my_head.all()){return false;}
+		if(first.sn()!=my_head.sn()){
+			fixList(my_tail,my_head,tid);
+			continue;
+		}
+		if(head.CAS(my_head,first.ptr())){
+			bp->free(my_head.ptr(),tid);
+			return true;
+		}
+		return false;
+	}
+}
@@ -0,0 +1,89 @@
+/*
+
+Copyright 2015 University of Rochester
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+
+
+
+
+
+// Optimistic FIFO queue.
+//
+// See:
+//   E. Ladan-Mozes and N. Shavit. An optimistic approach to
+//   lock-free FIFO queues. DISC 2004.
+//
+// An MSQueue with the links reversed: each node's next points
+// from the tail toward the head and is written before the node
+// is published, so an enqueue is a single CAS on tail.  The prev
+// links that dequeues follow are set afterwards with a plain
+// store, and a dequeue that finds one missing or stale repairs
+// them from tail with fixList().  Tags count positions: the node
+// enqueued as the i-th carries tag i in tail, head, its own next
+// and its predecessor's prev, which is how stale prevs are told.
+//
+// Like MSQueue, freed nodes go straight back to the BlockPool
+// and may still be read; the tags keep the CASes honest.  peek()'s
+// key is head, so remove_cond() fails once anything is dequeued.
+
+
+#ifndef OPTIMISTIC_QUEUE_H
+#define OPTIMISTIC_QUEUE_H
+
+#include "RDualContainer.hpp"
+#include "BlockPool.hpp"
+
+class OptimisticQueue : public virtual RPeekableContainer, public virtual RQueue, public Reportable{
+
+	class Node{
+	public:
+		cptr<Node> next; // toward head, never changes once published
+		cptr<Node> prev; // toward tail, set after the enqueue's CAS
+		int32_t val;
+	};
+
+	cptr<Node> head
+	__attribute__(( aligned(CACHE_LINE_SIZE) )); uint8_t pad1[CACHE_LINE_SIZE-sizeof(cptr<Node>)]; // pad
+	cptr<Node> tail
+	__attribute__(( aligned(CACHE_LINE_SIZE) )); uint8_t pad2[CACHE_LINE_SIZE-sizeof(cptr<Node>)]; // pad
+
+	BlockPool<Node>* bp;
+	int task_num;
+	padded<int64_t>* fixes; // fixList calls, per thread
+
+	void fixList(cptr_local<Node> my_tail, cptr_local<Node> my_head, int tid);
+
+public:
+	OptimisticQueue(int task_num, bool glibc_mem);
+
+	void conclude();
+
+	void enqueue(int32_t val,int tid);
+	int32_t dequeue(int tid);
+	void insert(int32_t val,int tid){return enqueue(val,tid);}
+	int32_t remove(int tid){return dequeue(tid);}
+	KeyVal peek(int tid);
+	bool remove_cond(uint64_t key, int tid);
+};
+
+class OptimisticQueueFactory : public RContainerFactory{
+	OptimisticQueue* build(GlobalTestConfig* gtc){
+		return new OptimisticQueue(gtc->task_num,gtc->environment["glibc"]=="1");
+	}
+};
+
+#endif
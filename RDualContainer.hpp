@@ -65,6 +65,31 @@ public:
 	virtual void insert(int32_t val,int tid)=0;
 	virtual KeyVal peek(int tid)=0;
 	virtual bool remove_cond(uint64_t key, int tid)=0;
+
+	// Batched forms, one item at a time unless overridden.
+	// remove_batch removes up to k items into vals and returns
+	// how many, fewer than k only if the container ran empty.
+	virtual int remove_batch(int k, int32_t* vals, int tid){
+		int n = 0;
+		int32_t v;
+		while(n<k){
+			v = remove(tid);
+			if(v==EMPTY){break;}
+			vals[n++] = v;
+		}
+		return n;
+	}
+	// peek_range peeks up to k items from the front, keyed as
+	// by peek(), and remove_cond_range removes the longest prefix
+	// of those n still at the front, returning its length
+	virtual int peek_range(int k, KeyVal* kvs, int tid){
+		if(k<1){return 0;}
+		kvs[0] = peek(tid);
+		return kvs[0].val==EMPTY?0:1;
+	}
+	virtual int remove_cond_range(KeyVal* kvs, int n, int tid){
+		return (n>0 && remove_cond(kvs[0].key,tid))?1:0;
+	}
 };
 
 class RDualContainer : public virtual RContainer{
@@ -73,4 +98,29 @@ public:
 	virtual void insert(int32_t val,int tid)=0;
 };
 
+// continuation for a remove that would otherwise block;
+// wake() is called exactly once, on the thread (tid) of
+// the insert that satisfied it, and must not block
+class DualWaiter{
+public:
+	virtual void wake(int32_t val,int tid)=0;
+};
+
+// a dual container whose waiters can park instead of spin.
+// removeAsync returns the value if the remove completed at
+// once, else EMPTY, with w published in place of the spin
+// target and woken later by the satisfying insert
+class RAsyncDualContainer : public virtual RDualContainer{
+public:
+	virtual int32_t removeAsync(DualWaiter* w,int tid)=0;
+};
+
+// a dual container matched by key: remove(key) waits for
+// an insert of that key, and returns its val
+class RKeyedDualContainer : public virtual Rideable{
+public:
+	virtual int32_t remove(int32_t key,int tid)=0;
+	virtual void insert(int32_t key,int32_t val,int tid)=0;
+};
+
 #endif
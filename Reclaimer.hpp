@@ -0,0 +1,378 @@
+/*
+
+Copyright 2015 University of Rochester
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+
+
+#ifndef RECLAIMER_HPP
+#define RECLAIMER_HPP
+
+#ifndef _REENTRANT
+#define _REENTRANT		/* basic 3-lines for threads */
+#endif
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string>
+#include <atomic>
+#include "ConcurrentPrimitives.hpp"
+#include "BlockPool.hpp"
+#include "RContainer.hpp"
+
+
+// Pluggable reclamation for the linked ring queues.
+//
+// A node type T must provide
+//	uint64_t index;        // position in the ring list (head index scheme)
+//	T* retired_next;       // intrusive link for the retired list
+//	uint64_t birth_era;    // stamped by onAlloc
+//	uint64_t retire_era;   // stamped by retire
+// The retired list is threaded through the nodes themselves,
+// so retiring never allocates.  Lists are scanned once they hold
+// batch nodes, which amortizes the pass over every thread's
+// reservation.
+//
+// An operation brackets its accesses with begin() and end().
+// begin() may be repeated at the top of a retry loop; after
+// loading a node pointer from the shared list the caller must
+// check stable(), and reload if it fails.
+//
+// Schemes:
+//	RECLAIM_HEAD_INDEX	reservation is the list's head index at
+//		begin(); frees rings whose index is below every reservation.
+//		This is the scheme LCRQ has always used.
+//	RECLAIM_EBR	epoch based (Fraser); reservation is the global
+//		epoch at begin(), which advances during scans.
+//	RECLAIM_IBR	2GE interval based (Wen et al.); each thread
+//		reserves the era interval it may have read in, and a node
+//		is freed once its lifetime overlaps no reservation.  Unlike
+//		the others it only protects nodes born within the interval.
+
+enum ReclaimerType{RECLAIM_HEAD_INDEX, RECLAIM_EBR, RECLAIM_IBR};
+
+template<class T>
+class Reclaimer{
+protected:
+	struct RetiredList{
+		T* head;
+		T* tail;
+		int size;
+	};
+
+	int task_num;
+	int batch;
+	BlockPool<T>* bp;
+	padded<RetiredList>* retired;
+	std::atomic<int64_t> pending; // retired but not yet freed
+	std::atomic<int64_t> peak;
+
+	// taken once per scan, passed to safe()
+	virtual uint64_t bound(int tid)=0;
+	virtual bool safe(T* n, uint64_t bound)=0;
+	virtual uint64_t currentEra()=0;
+
+public:
+	Reclaimer(int task_num, BlockPool<T>* bp, int batch){
+		this->task_num = task_num;
+		this->bp = bp;
+		this->batch = batch<1?1:batch;
+		retired = new padded<RetiredList>[task_num];
+		for(int i = 0; i<task_num; i++){
+			retired[i].ui.head = NULL;
+			retired[i].ui.tail = NULL;
+			retired[i].ui.size = 0;
+		}
+		pending.store(0);
+		peak.store(0);
+	}
+
+	// only call once no thread is operating on the container
+	virtual ~Reclaimer(){
+		for(int i = 0; i<task_num; i++){
+			T* n = retired[i].ui.head;
+			while(n!=NULL){
+				T* next = n->retired_next;
+				bp->free(n,i);
+				n = next;
+			}
+		}
+		delete[] retired;
+	}
+
+	virtual void onAlloc(T* n, int tid){
+		n->birth_era = currentEra();
+	}
+
+	virtual void begin(int tid, uint64_t head_index)=0;
+	virtual bool stable(int tid){return true;}
+	virtual void end(int tid)=0;
+
+	// n must already be unreachable from the shared list
+	void retire(T* n, int tid){
+		RetiredList* l = &(retired[tid].ui);
+		n->retire_era = currentEra();
+		n->retired_next = NULL;
+		if(l->tail==NULL){l->head = n;}
+		else{l->tail->retired_next = n;}
+		l->tail = n;
+		l->size++;
+		int64_t p = pending.fetch_add(1,std::memory_order_relaxed)+1;
+		int64_t pk = peak.load(std::memory_order_relaxed);
+		while(p>pk && !peak.compare_exchange_weak(pk,p,std::memory_order_relaxed)){}
+		if(l->size>=batch){
+			scan(tid);
+		}
+	}
+
+	// free every node on tid's list that no reservation covers
+	void scan(int tid){
+		RetiredList* l = &(retired[tid].ui);
+		uint64_t b = bound(tid);
+		T* prev = NULL;
+		T* n = l->head;
+		int freed = 0;
+		while(n!=NULL){
+			T* next = n->retired_next;
+			if(safe(n,b)){
+				if(prev==NULL){l->head = next;}
+				else{prev->retired_next = next;}
+				if(l->tail==n){l->tail = prev;}
+				bp->free(n,tid);
+				freed++;
+			}
+			else{
+				prev = n;
+			}
+			n = next;
+		}
+		l->size-=freed;
+		pending.fetch_sub(freed,std::memory_order_relaxed);
+	}
+
+	// a departing thread's reservation no longer holds anything up;
+	// what can't be freed yet stays with the slot
+	void releaseSlot(int tid){
+		end(tid);
+		scan(tid);
+	}
+
+	int64_t retiredNow(){return pending.load();}
+	int64_t retiredPeak(){return peak.load();}
+	int getBatch(){return batch;}
+	virtual const char* name()=0;
+};
+
+
+template<class T>
+class HeadIndexReclaimer : public Reclaimer<T>{
+	volatile_padded<uint64_t>* hazard;
+
+	uint64_t bound(int tid){
+		uint64_t min_hazard = UINT64_MAX;
+		for(int i = 0; i<this->task_num; i++){
+			if(hazard[i].ui<min_hazard){
+				min_hazard=hazard[i].ui;
+			}
+		}
+		return min_hazard;
+	}
+	bool safe(T* n, uint64_t min_hazard){return n->index<min_hazard;}
+	uint64_t currentEra(){return 0;}
+
+public:
+	HeadIndexReclaimer(int task_num, BlockPool<T>* bp, int batch) : Reclaimer<T>(task_num,bp,batch){
+		hazard = new volatile_padded<uint64_t>[task_num];
+		for(int i = 0; i<task_num; i++){
+			hazard[i].ui=UINT64_MAX;
+		}
+	}
+	~HeadIndexReclaimer(){delete[] hazard;}
+
+	// head_index is guaranteed to be less than or equal
+	// to the actual head index, so nothing above it can be freed
+	void begin(int tid, uint64_t head_index){hazard[tid].ui=head_index;}
+	void end(int tid){hazard[tid].ui=UINT64_MAX;}
+	const char* name(){return "headindex";}
+};
+
+
+template<class T>
+class EpochReclaimer : public Reclaimer<T>{
+	volatile uint64_t epoch;
+	char pad1[LEVEL1_DCACHE_LINESIZE-sizeof(uint64_t)];
+	volatile_padded<uint64_t>* announce; // UINT64_MAX when quiescent
+
+	// advance the epoch if every active thread has seen it,
+	// then return the oldest epoch still announced
+	uint64_t bound(int tid){
+		uint64_t e = epoch;
+		uint64_t min_announce = UINT64_MAX;
+		for(int i = 0; i<this->task_num; i++){
+			uint64_t a = announce[i].ui;
+			if(a<min_announce){
+				min_announce = a;
+			}
+		}
+		if(min_announce==UINT64_MAX || min_announce==e){
+			__sync_bool_compare_and_swap(&epoch,e,e+1);
+		}
+		return min_announce;
+	}
+	// retired in an epoch no active thread still announces
+	bool safe(T* n, uint64_t min_announce){return n->retire_era<min_announce;}
+	uint64_t currentEra(){return epoch;}
+
+public:
+	EpochReclaimer(int task_num, BlockPool<T>* bp, int batch) : Reclaimer<T>(task_num,bp,batch){
+		epoch = 0;
+		announce = new volatile_padded<uint64_t>[task_num];
+		for(int i = 0; i<task_num; i++){
+			announce[i].ui=UINT64_MAX;
+		}
+	}
+	~EpochReclaimer(){delete[] announce;}
+
+	void begin(int tid, uint64_t head_index){
+		announce[tid].ui = epoch;
+		__sync_synchronize(); // announcement must precede our reads
+	}
+	void end(int tid){announce[tid].ui=UINT64_MAX;}
+	const char* name(){return "ebr";}
+};
+
+
+template<class T>
+class IntervalReclaimer : public Reclaimer<T>{
+	volatile uint64_t era;
+	char pad1[LEVEL1_DCACHE_LINESIZE-sizeof(uint64_t)];
+	struct Reservation{
+		volatile uint64_t lower; // UINT64_MAX when quiescent
+		volatile uint64_t upper;
+	};
+	padded<Reservation>* res;
+	padded<int>* allocs;
+	int eraFreq;
+
+	uint64_t bound(int tid){return 0;}
+	bool safe(T* n, uint64_t unused){
+		for(int i = 0; i<this->task_num; i++){
+			uint64_t lo = res[i].ui.lower;
+			uint64_t hi = res[i].ui.upper;
+			if(lo<=n->retire_era && n->birth_era<=hi){
+				return false;
+			}
+		}
+		return true;
+	}
+	uint64_t currentEra(){return era;}
+
+public:
+	IntervalReclaimer(int task_num, BlockPool<T>* bp, int batch, int eraFreq) : Reclaimer<T>(task_num,bp,batch){
+		era = 0;
+		this->eraFreq = eraFreq<1?1:eraFreq;
+		res = new padded<Reservation>[task_num];
+		allocs = new padded<int>[task_num];
+		for(int i = 0; i<task_num; i++){
+			res[i].ui.lower=UINT64_MAX;
+			res[i].ui.upper=0;
+			allocs[i].ui=0;
+		}
+	}
+	~IntervalReclaimer(){
+		delete[] res;
+		delete[] allocs;
+	}
+
+	void onAlloc(T* n, int tid){
+		if(++allocs[tid].ui%eraFreq==0){
+			__sync_fetch_and_add(&era,1);
+		}
+		n->birth_era = era;
+	}
+
+	// the interval starts at the first begin() of an operation,
+	// later calls (retries) only extend it
+	void begin(int tid, uint64_t head_index){
+		uint64_t e = era;
+		if(res[tid].ui.lower==UINT64_MAX){
+			res[tid].ui.upper = e;
+			res[tid].ui.lower = e;
+		}
+		else if(res[tid].ui.upper!=e){
+			res[tid].ui.upper = e;
+		}
+		__sync_synchronize();
+	}
+	// anything just read was born no later than the era
+	// we reserved, unless the era moved meanwhile
+	bool stable(int tid){
+		uint64_t e = era;
+		if(e==res[tid].ui.upper){
+			return true;
+		}
+		res[tid].ui.upper = e;
+		__sync_synchronize();
+		return false;
+	}
+	void end(int tid){
+		res[tid].ui.lower=UINT64_MAX;
+		res[tid].ui.upper=0;
+	}
+	const char* name(){return "ibr";}
+};
+
+
+// Scheme and batch threshold for a container's reclaimer.  The
+// harness sets them with -dreclaim=headindex|ebr|ibr and
+// -dreclaim_batch=N.  A batch of 0 picks the scheme's default;
+// the head index scheme scans on every retire, as it always has.
+struct ReclaimerConfig{
+	ReclaimerType type;
+	int batch;
+
+	ReclaimerConfig(){
+		type = RECLAIM_HEAD_INDEX;
+		batch = 0;
+	}
+	ReclaimerConfig(ReclaimerType type, int batch){
+		this->type = type;
+		this->batch = batch;
+	}
+	ReclaimerConfig(GlobalTestConfig* gtc){
+		std::string t = gtc->environment["reclaim"];
+		std::string b = gtc->environment["reclaim_batch"];
+		batch = b.empty()?0:atoi(b.c_str());
+		if(t=="ebr"){type = RECLAIM_EBR;}
+		else if(t=="ibr"){type = RECLAIM_IBR;}
+		else if(t.empty() || t=="headindex"){type = RECLAIM_HEAD_INDEX;}
+		else{errexit("Unknown reclamation scheme; use -dreclaim=headindex|ebr|ibr.");}
+	}
+};
+
+template<class T>
+Reclaimer<T>* buildReclaimer(ReclaimerConfig rc, int task_num, BlockPool<T>* bp){
+	switch(rc.type){
+	case RECLAIM_EBR:
+		return new EpochReclaimer<T>(task_num,bp,rc.batch?rc.batch:4);
+	case RECLAIM_IBR:
+		return new IntervalReclaimer<T>(task_num,bp,rc.batch?rc.batch:4,1);
+	default:
+		return new HeadIndexReclaimer<T>(task_num,bp,rc.batch?rc.batch:1);
+	}
+}
+
+#endif
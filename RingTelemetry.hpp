@@ -0,0 +1,137 @@
+/*
+
+Copyright 2015 University of Rochester
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+
+
+#ifndef RING_TELEMETRY_HPP
+#define RING_TELEMETRY_HPP
+
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/time.h>
+#include <vector>
+#include <algorithm>
+#include <iostream>
+#include "ConcurrentPrimitives.hpp"
+#include "RDualContainer.hpp"
+
+// Per ring lifetime records for the dual ring queues
+// (SPDQ's DCRQ and MPDQ's DRQ).  Only compiled in with
+// -DRING_TELEMETRY, so the default build pays nothing.
+// Each thread appends the record of a ring it retires to
+// its own buffer; buffers are merged and dumped at conclude().
+
+#ifdef RING_TELEMETRY
+#define TELEMETRY(stmt) stmt
+#else
+#define TELEMETRY(stmt)
+#endif
+
+class RingRecord{
+public:
+	uint64_t index; // position in the ring list
+	bool antidata; // polarity (for MPDQ, the majority polarity)
+	uint32_t data; // data elements enqueued in the ring
+	uint32_t antidata_elems; // antidata elements (waiters) enqueued in the ring
+	uint32_t mixed; // MPDQ only: elements matched inside the ring
+	uint32_t close_idx; // index at which ring was closed
+	uint64_t head_usec; // time spent as head
+	bool closed_full; // closed by an enqueuer, because full or starving
+	bool sealed_empty; // sealed (SPDQ) or abandoned (MPDQ) once empty
+	bool live; // still in the list at conclude()
+	uint32_t fixstates; // SPDQ only: tail<head repairs
+	uint32_t emptychecks; // SPDQ only: dequeuer overshoot checks
+
+	bool operator<(const RingRecord& r) const{return index<r.index;}
+};
+
+class RingTelemetry{
+	padded<std::vector<RingRecord>>* buffers;
+	int task_num;
+
+public:
+	static uint64_t usec(){
+		struct timeval tv;
+		gettimeofday(&tv,NULL);
+		return ((uint64_t)tv.tv_sec)*1000000+tv.tv_usec;
+	}
+
+	RingTelemetry(int task_num){
+		this->task_num = task_num;
+		buffers = new padded<std::vector<RingRecord>>[task_num];
+	}
+
+	~RingTelemetry(){
+		delete[] buffers;
+	}
+
+	void record(const RingRecord& r, int tid){
+		buffers[tid].ui.push_back(r);
+	}
+
+	// merge all thread buffers, print a summary, and write
+	// one csv line per ring to <name>_rings.csv
+	void dump(const char* name){
+		std::vector<RingRecord> all;
+		for(int i = 0; i<task_num; i++){
+			all.insert(all.end(),buffers[i].ui.begin(),buffers[i].ui.end());
+			buffers[i].ui.clear();
+		}
+		std::sort(all.begin(),all.end());
+
+		uint64_t elems[2] = {0,0};
+		uint64_t usec[2] = {0,0};
+		uint64_t rings[2] = {0,0};
+		uint64_t flips = 0, full = 0, fix = 0, chk = 0;
+		char fname[256];
+		snprintf(fname,sizeof(fname),"%s_rings.csv",name);
+		FILE* f = fopen(fname,"w");
+		if(f!=NULL){
+			fprintf(f,"index,antidata,data,antidata_elems,mixed,close_idx,head_usec,"
+			  "closed_full,sealed_empty,live,fixstates,emptychecks\n");
+		}
+		for(size_t i = 0; i<all.size(); i++){
+			RingRecord& r = all[i];
+			rings[r.antidata]++;
+			elems[r.antidata]+= r.data+r.antidata_elems;
+			usec[r.antidata]+= r.head_usec;
+			if(i>0 && all[i-1].antidata!=r.antidata){flips++;}
+			if(r.closed_full){full++;}
+			fix+=r.fixstates;
+			chk+=r.emptychecks;
+			if(f!=NULL){
+				fprintf(f,"%llu,%d,%u,%u,%u,%u,%llu,%d,%d,%d,%u,%u\n",
+				  (unsigned long long)r.index,r.antidata,r.data,r.antidata_elems,r.mixed,
+				  r.close_idx,(unsigned long long)r.head_usec,r.closed_full,r.sealed_empty,
+				  r.live,r.fixstates,r.emptychecks);
+			}
+		}
+		if(f!=NULL){fclose(f);}
+
+		std::cout<<name<<" rings="<<all.size()<<" polarity_flips="<<flips
+		  <<" closed_full="<<full<<" fixstates="<<fix<<" emptychecks="<<chk<<std::endl;
+		for(int p = 0; p<2; p++){
+			if(rings[p]==0){continue;}
+			std::cout<<name<<(p==DATA?" data":" antidata")<<" rings="<<rings[p]
+			  <<" avg_elements="<<elems[p]/rings[p]
+			  <<" avg_head_usec="<<usec[p]/rings[p]<<std::endl;
+		}
+	}
+};
+
+#endif
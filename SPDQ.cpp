@@ -45,6 +45,13 @@ void SPDQ::DCRQ::initRingQueue(uint64_t index, bool antidata, bool lock_free){
 	this->antidata = antidata;
 	this->lock_free = lock_free;
 	this->sealed = false;
+	#ifdef RING_TELEMETRY
+	this->t_elements = 0;
+	this->t_fixstates = 0;
+	this->t_emptychecks = 0;
+	this->t_closed_full = false;
+	this->t_head_start = 0;
+	#endif
 
 	if(lock_free && this->antidata){
 		initNode(&this->ring[i],1,1,0,NULL_VAL);
@@ -121,6 +128,7 @@ void SPDQ::DCRQ::fixstate(){
 
 		h.closed=t.closed;  // h.closed is never used, so we make sure it's the same as the tail
 		if(__sync_bool_compare_and_swap (&this->tail.ui, t.ui, h.ui)){ 
+			TELEMETRY(__sync_fetch_and_add(&t_fixstates,1));
 			return;  // moved tail to head (queue has size zero), but is consistent
 		}
 		return;
@@ -131,6 +139,7 @@ void SPDQ::DCRQ::fixstate(){
 
 int SPDQ::DCRQ::emptycheck(const struct idx_struct h){
 	struct idx_struct t;
+	TELEMETRY(__sync_fetch_and_add(&t_emptychecks,1));
 	//t.ui = __sync_fetch_and_add (&dcrq->tail.ui,0);
 	t.ui = this->tail.ui;
 	if( t.idx<= h.idx+1){
@@ -429,7 +438,7 @@ int32_t SPDQ::DCRQ::enqueue(bool antidata, int32_t arg){
 				if(__sync_bool_compare_and_swap (&(node->ui), localnodecopy.ui, newnode.ui)){  // enqueue
 					assert(node->val == arg || node->loc.idx>t.idx);
 					assert(node->val == arg || (this->head.idx>t.idx));
-
+					TELEMETRY(__sync_fetch_and_add(&t_elements,1));
 					return OK;
 				}
 			}
@@ -440,6 +449,7 @@ int32_t SPDQ::DCRQ::enqueue(bool antidata, int32_t arg){
 		// if we find ourselves overlapping head, we close the queue
 		// everyone who discovers this closes the queue
 		if((t.idx>=h.idx+R) || starvation_level>=_STARVATION){ 
+			TELEMETRY(t_closed_full = true);
 			this->tail.close();
 			return CLOSED; // we've closed this ring because it's full.
 		}
@@ -448,7 +458,7 @@ int32_t SPDQ::DCRQ::enqueue(bool antidata, int32_t arg){
 }
 
 
-SPDQ::SPDQ(int t_num, bool glibc_mem,bool lock_free){
+SPDQ::SPDQ(int t_num, bool glibc_mem,bool lock_free, ReclaimerConfig rc){
 	int i,j;
 	// init block pool
 	bp = new BlockPool<struct DCRQ>(t_num,glibc_mem);
@@ -468,19 +478,21 @@ SPDQ::SPDQ(int t_num, bool glibc_mem,bool lock_free){
 	}*/
 
 
+	reclaimer = buildReclaimer<DCRQ>(rc,t_num,bp);
 	head.ptr = (struct DCRQ*)bp->alloc(0); //(malloc(sizeof(struct DCRQ));
 	head.cntr=0;
 	head.ptr->initRingQueue(0,true,lock_free);
+	reclaimer->onAlloc(head.ptr,0);
+	#ifdef RING_TELEMETRY
+	telemetry = new RingTelemetry(t_num);
+	head.ptr->t_head_start = RingTelemetry::usec();
+	#endif
 	head_index = 0;
 	tail=head;
 	tail.cntr = 0;
-	hazard = new struct volatile_padded<uint64_t>[t_num];
 	task_num = t_num;
-	retired = new struct volatile_padded<std::list<struct DCRQ*>*>[t_num];
 	waiters = new struct padded<DCRQ_wait>[t_num];
 	for(i=0;i<task_num;i++){
-		retired[i].ui=new std::list<struct DCRQ*>();
-		hazard[i].ui=UINT64_MAX;
 		waiters[i].ui.set(0,1);
 	}
 
@@ -510,48 +522,48 @@ SPDQ::~SPDQ(){
 		garbage = next_dcrq;
 	}*/
 	//while(this->dequeue()!=EMPTY){}
-	delete[] retired;
-	delete[] hazard;
+	delete reclaimer;
+	#ifdef RING_TELEMETRY
+	delete telemetry;
+	#endif
 }
 
-void SPDQ::retire(int tid, struct DCRQ* dcrq){
-	int i;
-	uint64_t min_hazard;
-	min_hazard = UINT64_MAX;
-	long idx;
-	struct DCRQ old;
-	struct DCRQ* garbage;
-	old = *dcrq;
-	for(i=0;i<task_num;i++){
-		if(hazard[i].ui<min_hazard){
-			min_hazard=hazard[i].ui;
-		}
-	}
-
-	if(min_hazard>dcrq->index){
-		// dcrq is already clear,
-		// we can free it
-		bp->free(dcrq,tid);
-	}
-	else{
-		// dcrq is not clear
-		// append it to the retired list
-		retired[tid].ui->push_back(dcrq);
-		
-	}
-
-	// while we're here, lets empty our retired list
-	// anything on our list is unique,
-	// since it got there by us successfully removing it from
-	// the head pointer
-	while(retired[tid].ui->size()>0 && (*retired[tid].ui->begin())->index<min_hazard){
+#ifdef RING_TELEMETRY
+// record this ring's life in tid's telemetry buffer.
+// called by the thread that swings the ring off the head,
+// or at conclude() for rings still in the list
+void SPDQ::DCRQ::report(RingTelemetry* tel, bool live, int tid){
+	RingRecord r;
+	r.index = index;
+	r.antidata = antidata;
+	r.data = antidata?0:t_elements;
+	r.antidata_elems = antidata?t_elements:0;
+	r.mixed = 0;
+	r.close_idx = tail.idx;
+	r.head_usec = t_head_start==0?0:RingTelemetry::usec()-t_head_start;
+	r.closed_full = t_closed_full;
+	r.sealed_empty = sealed;
+	r.live = live;
+	r.fixstates = t_fixstates;
+	r.emptychecks = t_emptychecks;
+	tel->record(r,tid);
+}
+#endif
 
-		garbage = *retired[tid].ui->begin();
-		idx = garbage->index;
-		retired[tid].ui->pop_front(); 
-		bp->free(garbage,tid);
+void SPDQ::conclude(){
+	#ifdef RING_TELEMETRY
+	for(DCRQ* d = head.ptr; d!=NULL; d = d->next){
+		d->report(telemetry,true,0);
 	}
+	telemetry->dump("SPDQ");
+	#endif
+	std::cout<<"reclaim="<<reclaimer->name()<<" batch="<<reclaimer->getBatch()
+	  <<" retired@Peak="<<reclaimer->retiredPeak()
+	  <<" ("<<reclaimer->retiredPeak()*sizeof(DCRQ)/1024<<"KB)"<<std::endl;
+}
 
+void SPDQ::releaseSlot(int tid){
+	reclaimer->releaseSlot(tid);
 }
 
 
@@ -568,14 +580,17 @@ int32_t SPDQ::_dequeue(DCRQ_ptr h, bool antidata, int32_t arg, int tid){
 	newdcrq.ptr=NULL;
 
 	while(true){
-		hazard[tid].ui= head_index; // get head_index, it is guaranteed to be 
+		reclaimer->begin(tid,head_index); // get head_index, it is guaranteed to be 
 								// less than or equal to the actual head index
 								// we set it as our hazard index.  Nothing
 								// above it can be freed
 		dcrq = head;
+		if(!reclaimer->stable(tid)){
+			continue;
+		}
 		if(dcrq.ptr->antidata==antidata){// && 
 			// then head changed beneath us
-			hazard[tid].ui=UINT64_MAX;
+			reclaimer->end(tid);
 			//w->wipe();
 			return EMPTY;
 		}
@@ -586,13 +601,13 @@ int32_t SPDQ::_dequeue(DCRQ_ptr h, bool antidata, int32_t arg, int tid){
 			continue;
 		}
 		else if(v!= EMPTY){
-			hazard[tid].ui=UINT64_MAX; // reset our hazard index
+			reclaimer->end(tid); // reset our hazard index
 			//w->wipe();
 			return v;  // dequeued successfully, return
 		} 
 		// seal empty DCRQ so we can remove it
 		else if(!dcrq.ptr->seal()){
-			hazard[tid].ui=UINT64_MAX;
+			reclaimer->end(tid);
 			continue;
 		}
 		assert(dcrq.ptr->seal());
@@ -610,6 +625,7 @@ int32_t SPDQ::_dequeue(DCRQ_ptr h, bool antidata, int32_t arg, int tid){
 					abort();
 				}
 				newdcrq.ptr->initRingQueue(0,antidata,lock_free);
+				reclaimer->onAlloc(newdcrq.ptr,tid);
 				// enqueue me
 				if(antidata){
 					arg = (int32_t) w;
@@ -632,18 +648,20 @@ int32_t SPDQ::_dequeue(DCRQ_ptr h, bool antidata, int32_t arg, int tid){
 				// swing head
 				swingHead(dcrq,tid);
 				
-				// wait until satisfied, then return the value
+				// wait until satisfied, then return the value.
+				// The waiter is our own slot, not in any ring,
+				// so drop the reservation before parking on it
 				if(antidata){
+					reclaimer->end(tid); 
 					//printf("%d: apwait\n",tid);
 					while(!w->is_sat()){} 
 					//printf("%d: done\n",tid);
-					hazard[tid].ui=UINT64_MAX; 
 					uint32_t v = w->val();
 					//w->wipe();
 					return v;
 				}
 				else{	
-					hazard[tid].ui=UINT64_MAX;
+					reclaimer->end(tid);
 					return OK;
 				}
 			}
@@ -655,7 +673,7 @@ int32_t SPDQ::_dequeue(DCRQ_ptr h, bool antidata, int32_t arg, int tid){
 		else{
 			// else, the head is sealed, but has a next, so swing it and try again
 			swingHead(dcrq,tid);
-			hazard[tid].ui=UINT64_MAX;
+			reclaimer->end(tid);
 		}
 	}
 
@@ -669,13 +687,20 @@ int32_t SPDQ::_enqueue(DCRQ_ptr h, bool antidata, int32_t arg, int tid){
 
 	newdcrq.ptr=NULL;
 	while(true){ 
-		hazard[tid].ui=head_index; // get head_index, it is guaranteed to be 
+		reclaimer->begin(tid,head_index); // get head_index, it is guaranteed to be 
 								// less than or equal to the actual head and tail index
 								// we set it as our hazard index.  Nothing
 								// above it can be freed
 		dcrq = tail;
+		if(!reclaimer->stable(tid)){
+			continue;
+		}
 		if(dcrq.ptr->next!=NULL){
 			newdcrq.ptr = dcrq.ptr->next;
+			if(!reclaimer->stable(tid)){
+				newdcrq.ptr=NULL;
+				continue;
+			}
 			newdcrq.ptr->index = dcrq.ptr->index+1; 
 			newdcrq.cntr = dcrq.cntr+1; 
 			__sync_bool_compare_and_swap (&tail.ui, dcrq.ui,newdcrq.ui); // update tail pointer
@@ -688,7 +713,7 @@ int32_t SPDQ::_enqueue(DCRQ_ptr h, bool antidata, int32_t arg, int tid){
 			if(head.ptr==h.ptr && h.ptr->seal()){
 				swingHead(h,tid);
 			}
-			hazard[tid].ui=UINT64_MAX;
+			reclaimer->end(tid);
 			return CLOSED;
 		}
 		if(dcrq.ptr->next!=NULL){ 
@@ -699,7 +724,7 @@ int32_t SPDQ::_enqueue(DCRQ_ptr h, bool antidata, int32_t arg, int tid){
 			continue;
 		}
 		if(dcrq.ptr->enqueue(antidata,arg)==OK){ // successfully enqueued
-			//hazard[tid].ui=UINT64_MAX; // reset our hazard index 
+			reclaimer->end(tid); // reset our hazard index, a waiter must not hold it while spinning
 			if(newdcrq.ptr!=NULL){
 				bp->free(newdcrq.ptr,tid);
 			} 
@@ -716,6 +741,7 @@ int32_t SPDQ::_enqueue(DCRQ_ptr h, bool antidata, int32_t arg, int tid){
 				abort();
 			}
 			newdcrq.ptr->initRingQueue(0,antidata,lock_free);
+			reclaimer->onAlloc(newdcrq.ptr,tid);
 			if(newdcrq.ptr->enqueue( antidata, arg)!=OK){
 				bp->free(newdcrq.ptr,tid);
 				newdcrq.ptr=NULL;
@@ -726,7 +752,7 @@ int32_t SPDQ::_enqueue(DCRQ_ptr h, bool antidata, int32_t arg, int tid){
 		}
 		// append ring
 		if(appendRing(dcrq,newdcrq)){
-			hazard[tid].ui=UINT64_MAX; // reset our hazard index
+			reclaimer->end(tid); // reset our hazard index
 			return OK;
 		}
 		else{
@@ -761,7 +787,11 @@ bool SPDQ::swingHead(DCRQ_ptr h, int tid){
 	if(__sync_bool_compare_and_swap(&head.ui, dcrq.ui,dcrq_next.ui)){ 
 		__sync_fetch_and_add (&head_index, 1);  // update head index
 		//printf("hi: %d",head_index);
-		retire(tid,dcrq.ptr);
+		#ifdef RING_TELEMETRY
+		dcrq_next.ptr->t_head_start = RingTelemetry::usec();
+		dcrq.ptr->report(telemetry,false,tid);
+		#endif
+		reclaimer->retire(dcrq.ptr,tid);
 		return true;
 	}
 	return false;
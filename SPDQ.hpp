@@ -31,10 +31,13 @@ limitations under the License.
 #include <atomic>
 #include "RDualContainer.hpp"
 #include "BlockPool.hpp"
+#include "RingTelemetry.hpp"
+#include "ThreadRegistry.hpp"
+#include "Reclaimer.hpp"
 
 
 // single polarity dual ring queue
-class SPDQ: public virtual RDualContainer{
+class SPDQ: public virtual RDualContainer, public Reportable, public SlotOwner{
 
 	const static int _RING_SIZE = 2048; // TODO make nonstatic
 	const static int _STARVATION = 2; // TODO make nonstatic
@@ -168,7 +171,10 @@ public:
 		char pad3[LEVEL1_DCACHE_LINESIZE-sizeof(struct DCRQ*)]; // padding to cache line size
 
 		uint64_t index;
-		char pad4[LEVEL1_DCACHE_LINESIZE-sizeof(uint64_t)]; // padding to cache line size
+		struct DCRQ* retired_next; // reclamation bookkeeping, see Reclaimer.hpp
+		uint64_t birth_era;
+		uint64_t retire_era;
+		char pad4[LEVEL1_DCACHE_LINESIZE-3*sizeof(uint64_t)-sizeof(struct DCRQ*)]; // padding to cache line size
 
 		bool antidata;
 		char pad5[LEVEL1_DCACHE_LINESIZE-sizeof(bool)]; // padding to cache line size
@@ -182,6 +188,15 @@ public:
 
 		bool sealed;
 
+		#ifdef RING_TELEMETRY
+		uint32_t t_elements;
+		uint32_t t_fixstates;
+		uint32_t t_emptychecks;
+		bool t_closed_full;
+		uint64_t t_head_start;
+		void report(RingTelemetry* tel, bool live, int tid);
+		#endif
+
 	private:
 		void fixstate();
 		int emptycheck(const struct idx_struct h);
@@ -282,18 +297,22 @@ public:
 	
 	struct padded<DCRQ_wait>* waiters;
 
-	struct volatile_padded<uint64_t>* hazard;
-	struct volatile_padded<std::list< DCRQ*>*>* retired;
+	Reclaimer<DCRQ>* reclaimer;
 	int task_num;
 	bool lock_free;
 	BlockPool<DCRQ>* bp;
+	#ifdef RING_TELEMETRY
+	RingTelemetry* telemetry;
+	#endif
 
-	SPDQ(int t_num, bool glibc_mem,bool lock_free);
+	SPDQ(int t_num, bool glibc_mem,bool lock_free, ReclaimerConfig rc=ReclaimerConfig());
 	~SPDQ();
 
+	void conclude();
+
 	int32_t remove(int tid);
 	void insert(int32_t arg, int tid);
-	void retire(int tid, struct DCRQ* dcrq);
+	void releaseSlot(int tid);
 
 };
 
@@ -308,7 +327,7 @@ public:
 	}
 
 	SPDQ* build(GlobalTestConfig* gtc){
-		return new SPDQ(gtc->task_num, gtc->environment["glibc"]=="1",nonblocking);
+		return new SPDQ(gtc->task_num, gtc->environment["glibc"]=="1",nonblocking,ReclaimerConfig(gtc));
 	}
 
 };
@@ -19,6 +19,7 @@
 
 
 #include "SSDualQueue.hpp"
+#include <iostream>
 
 /* ****************************************************************** */
 /* Types                                                              */
@@ -45,7 +46,7 @@
     Paremeter is pool from which to allocate blocks for queue.
     Return value is an opaque pointer.
 */
-SSDualQueue::SSDualQueue(int t_num,bool glibc_mem)
+SSDualQueue::SSDualQueue(int t_num,bool glibc_mem,bool use_hazards)
 {
 	int i,j;
     dqnode_t *qn;
@@ -78,6 +79,18 @@ SSDualQueue::SSDualQueue(int t_num,bool glibc_mem)
 		}
 	}
 
+	// slot 0 holds the head or tail node being read,
+	// slot 1 the node behind it
+	hazards = NULL;
+	if(use_hazards){
+		hazards = new HazardTracker(t_num, this->bp, 2, 5, true);
+	}
+
+	spare = new padded<dqnode_t*>[t_num];
+	for(i=0;i<t_num;i++){
+		spare[i].ui = NULL;
+	}
+
 	assert(sizeof(std::atomic<uint64_t>)==sizeof(uint64_t));
 	assert(head.all.is_lock_free());
 	assert(tail.all.is_lock_free());
@@ -87,6 +100,47 @@ SSDualQueue::SSDualQueue(int t_num,bool glibc_mem)
 
 
 
+/* Take the thread's spare node, or a fresh one from the pool. */
+dqnode_t* SSDualQueue::allocSpare(int tid){
+	dqnode_t* n = spare[tid].ui;
+	if(n!=NULL){
+		spare[tid].ui = NULL;
+		return n;
+	}
+	return (dqnode_t *)this->bp->alloc(tid);
+}
+
+/* Keep a node no other thread can reach as the spare, if
+   there isn't one already. */
+void SSDualQueue::freeSpare(dqnode_t* n, int tid){
+	if(spare[tid].ui==NULL){
+		spare[tid].ui = n;
+	}
+	else{
+		this->bp->free(n, tid);
+	}
+}
+
+
+/* Reserve n, read from src as seen, and check src still holds
+   it, so n can't have been retired before the reservation. */
+bool SSDualQueue::protect(dqnode_t* n, int slot, cnt_ptr<dqnode_t>& src, cnt_ptr_local<dqnode_t>& seen, int tid){
+	if(hazards==NULL){return true;}
+	hazards->reserve(n, slot, tid);
+	return src.all.load()==seen.all;
+}
+
+/* n has been dequeued but others may still be reading it. */
+void SSDualQueue::reclaim(dqnode_t* n, int tid){
+	if(hazards==NULL){
+		this->bp->free(n, tid);
+	}
+	else{
+		hazards->retire(n, tid);
+	}
+}
+
+
 /* Add a datum to the queue. If a waiter is repsent, fill the oldest
    outstanding request for data. */
 void SSDualQueue::insert(int val, int tid)
@@ -114,6 +168,7 @@ void SSDualQueue::insert(int val, int tid)
 			   request with tail pointer as yet unswung) */
 			//atomic_thread_fence(std::memory_order_acquire);
 			tailptr = tail.ptr();
+			if(!protect(tailptr, 0, this->tail, tail, tid)){continue;}
 			next.all=tailptr->next.all.load();
 			//atomic_thread_fence(std::memory_order_acquire);
 			if (tail.all == this->tail.all.load()){
@@ -127,6 +182,7 @@ void SSDualQueue::insert(int val, int tid)
 					if (tailptr->next.CAS(next, newnode)){
 						/* Linked in. Try to swing ptr and we're done */
 						this->tail.CAS(tail, newnode);
+						if(hazards!=NULL){hazards->clearAll(tid);}
 						return;
 					}
 				}
@@ -137,6 +193,7 @@ void SSDualQueue::insert(int val, int tid)
 			/* Queue consists of requests.  Give data to first. */
 			//atomic_thread_fence(std::memory_order_acquire);
 			headptr = head.ptr();
+			if(!protect(headptr, 0, this->head, head, tid)){continue;}
 			next.all=headptr->next.all.load();
 			//atomic_thread_fence(std::memory_order_acquire);
 			if (tail.all != this->tail.all.load()){continue;}
@@ -149,7 +206,10 @@ void SSDualQueue::insert(int val, int tid)
 				bool success = (NULL == request.ptr() &&
 					headptr->request.CAS(request, newnode));
 				this->head.CAS(head, next.ptr());
-				if (success){return;}
+				if (success){
+					if(hazards!=NULL){hazards->clearAll(tid);}
+					return;
+				}
 			}
 		}
     }
@@ -157,16 +217,12 @@ void SSDualQueue::insert(int val, int tid)
 
 int SSDualQueue::remove(int tid){
 
-    dqnode_t *newreq = (dqnode_t *)this->bp->alloc(tid);
+    /* only allocated once we have to link a reservation */
+    dqnode_t *newreq = NULL;
     cnt_ptr_local<dqnode_t> head, tail, next;
     int result = 0xDEADBEEF; /* placeholder value */
     dqnode_t *headptr, *tailptr, *nextptr, *dataptr;
 
-    newreq->data = 0;
-    newreq->next.init(NULL,0,false,false);
-    newreq->request.init(NULL,0,true,false);
-    //atomic_thread_fence(std::memory_order_release);
-
     while (1)
     {
 		//atomic_thread_fence(std::memory_order_acquire);
@@ -180,6 +236,7 @@ int SSDualQueue::remove(int tid){
 			   outstanding datum with tail pointer as yet unswung) */
 			//atomic_thread_fence(std::memory_order_acquire);
 			tailptr = tail.ptr();
+			if(!protect(tailptr, 0, this->tail, tail, tid)){continue;}
 			next.all=tailptr->next.all.load();
 			//atomic_thread_fence(std::memory_order_acquire);
 			if (tail.all == this->tail.all.load()){
@@ -189,16 +246,23 @@ int SSDualQueue::remove(int tid){
 					this->tail.CAS(tail, next.ptr());
 				}
 				else{
+					if(newreq==NULL){
+						newreq = allocSpare(tid);
+						newreq->data = 0;
+						newreq->next.init(NULL,0,false,false);
+						newreq->request.init(NULL,0,true,false);
+					}
 					/* Try to link in a request for data. We tag our pointer 
 					   to make it clear that we're a request, not data. */
 					if (this->tail.CAS(next, newreq)){
 						/* Linked in. Try to swing the tail ptr. */
 						this->tail.CAS(tail, newreq);
 
-						/* Help someone else if I need to */
-						if (head.all == this->head.all){
+						/* Help someone else if I need to; tailptr
+						   stays reserved while we wait on it */
+						headptr = (dqnode_t *)head.ptr();
+						if (protect(headptr, 1, this->head, head, tid) && head.all == this->head.all){
 							//atomic_thread_fence(std::memory_order_acquire);
-							headptr = (dqnode_t *)head.ptr();
 							nextptr = (dqnode_t *)headptr->next.ptr();
 							//atomic_thread_fence(std::memory_order_acquire);
 							if (NULL != headptr->request.ptr()){
@@ -221,8 +285,11 @@ int SSDualQueue::remove(int tid){
 						dataptr = (dqnode_t *)tailptr->request.ptr();
 						atomic_thread_fence(std::memory_order_acquire);						
 						result = dataptr->data;
-						this->bp->free(dataptr, tid);
-						this->bp->free(tailptr, tid);
+						/* the datum node was only reachable through our
+						   request, so it can be our next reservation */
+						freeSpare(dataptr, tid);
+						reclaim(tailptr, tid);
+						if(hazards!=NULL){hazards->clearAll(tid);}
 						return result;
 					}
 				}
@@ -232,6 +299,7 @@ int SSDualQueue::remove(int tid){
 			/* Queue consists of real data. Dequeue a node to get some */
 			//atomic_thread_fence(std::memory_order_acquire);
 			headptr = (dqnode_t *)head.ptr();
+			if(!protect(headptr, 0, this->head, head, tid)){continue;}
 			next.all=headptr->next.all.load();
 			//atomic_thread_fence(std::memory_order_acquire);
 			if (head.all == this->head.all){
@@ -240,6 +308,7 @@ int SSDualQueue::remove(int tid){
 				if(nextptr==NULL){
 					//puts(" avoidedsegfault ");
 					continue;} // if queue was emptied after we decided it had data
+				if(!protect(nextptr, 1, this->head, head, tid)){continue;}
 
 				/* Read result first because a subsequent dequeue could
 				   free the next node */
@@ -248,8 +317,12 @@ int SSDualQueue::remove(int tid){
 				/* try to snip out the head of the queue */
 				if (this->head.CAS(head, next.ptr())){
 					/* Success! */
-					this->bp->free(headptr, tid);
-					this->bp->free(newreq, tid);
+					reclaim(headptr, tid);
+					if(hazards!=NULL){hazards->clearAll(tid);}
+					if(newreq!=NULL){
+						/* built on an earlier try but never linked */
+						freeSpare(newreq, tid);
+					}
 					return result;
 				}
 			}
@@ -257,4 +330,7 @@ int SSDualQueue::remove(int tid){
     }// end while
 }
 
-
+void SSDualQueue::conclude(){
+	std::cout<<"node_bytes="<<sizeof(dqnode_t)
+	  <<" reclaim="<<(hazards!=NULL?"hazard":"none")<<std::endl;
+}
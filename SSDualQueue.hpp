@@ -17,6 +17,7 @@
 #include <assert.h>
 
 #include "BlockPool.hpp"
+#include "HazardTracker.hpp"
 #include "RDualContainer.hpp"
 #include "ConcurrentPrimitives.hpp"
 //#include "atomic_ops.h"
@@ -106,6 +107,17 @@ public:
 };
 
 /* queue node representation */
+#ifdef SSDQ_COMPACT_NODE
+/* all fields on one line; aligning the node keeps
+   neighbouring nodes off it */
+typedef struct dqnode_t
+{
+    cnt_ptr<struct dqnode_t> request;
+    cnt_ptr<struct dqnode_t> next;
+    uint32_t data;
+} __attribute__((aligned(LEVEL1_DCACHE_LINESIZE)))
+dqnode_t;
+#else
 typedef struct dqnode_t
 {
     uint32_t data;
@@ -116,11 +128,12 @@ typedef struct dqnode_t
 	char pad3[LEVEL1_DCACHE_LINESIZE-sizeof(cnt_ptr<struct dqnode_t>)];
 } 
 dqnode_t;
+#endif
 
 
 
 /* interface */
-class SSDualQueue : public RDualContainer{
+class SSDualQueue : public RDualContainer, public Reportable{
 public:
 	cnt_ptr<dqnode_t> head;
 	char pad1[LEVEL1_DCACHE_LINESIZE-sizeof(cnt_ptr<dqnode_t>)];
@@ -128,14 +141,36 @@ public:
 	char pad2[LEVEL1_DCACHE_LINESIZE-sizeof(cnt_ptr<dqnode_t>)];
     BlockPool<struct dqnode_t>* bp;
 	char pad3[LEVEL1_DCACHE_LINESIZE-sizeof(BlockPool<struct dqnode_t>*)];
-	SSDualQueue(int t_num, bool glibc_mem);
+	// one unpublished node kept per thread, for the next
+	// reservation, so repeated requesters skip the pool
+	padded<dqnode_t*>* spare;
+	// NULL frees dequeued nodes straight to the pool, relying on
+	// the pointer counters and BlockPool type stability; otherwise
+	// they are retired through hazard pointers
+	HazardTracker* hazards;
+	SSDualQueue(int t_num, bool glibc_mem, bool use_hazards=false);
 	void insert(int32_t val, int tid);
 	int32_t remove(int tid);
+	void conclude();
+private:
+	dqnode_t* allocSpare(int tid);
+	void freeSpare(dqnode_t* n, int tid);
+	bool protect(dqnode_t* n, int slot, cnt_ptr<dqnode_t>& src, cnt_ptr_local<dqnode_t>& seen, int tid);
+	void reclaim(dqnode_t* n, int tid);
 };
 
+// -dssdq_reclaim=hazard|none picks the reclamation mode;
+// glibc memory defaults to hazard, since it isn't type stable
 class SSDualQueueFactory : public RContainerFactory{
 	SSDualQueue* build(GlobalTestConfig* gtc){
-		return new SSDualQueue(gtc->task_num, gtc->environment["glibc"]=="1");
+		bool glibc = gtc->environment["glibc"]=="1";
+		std::string r = gtc->environment["ssdq_reclaim"];
+		bool use_hazards;
+		if(r=="hazard"){use_hazards = true;}
+		else if(r=="none"){use_hazards = false;}
+		else if(r.empty()){use_hazards = glibc;}
+		else{errexit("Unknown SSDualQueue reclamation; use -dssdq_reclaim=hazard|none.");}
+		return new SSDualQueue(gtc->task_num, glibc, use_hazards);
 	}
 };
 
@@ -0,0 +1,159 @@
+/*
+
+Copyright 2015 University of Rochester
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+
+
+// Two process handoff benchmark.
+// A producer process passes count values to a consumer
+// process, either through a pipe (the baseline) or through
+// a queue in a shared segment.  The consumer attaches to the
+// segment with its own mapping, so the queue is exercised
+// at a different base address than it was created at.
+//
+// usage: shmbench <pipe|lcrq|spdq> [count]
+
+#ifndef _REENTRANT
+#define _REENTRANT		/* basic 3-lines for threads */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include "ShmSegment.hpp"
+#include "ShmLCRQ.hpp"
+#include "ShmSPDQ.hpp"
+
+using namespace std;
+
+#define PRODUCER 0
+#define CONSUMER 1
+
+static double now(){
+	struct timeval tv;
+	gettimeofday(&tv,NULL);
+	return tv.tv_sec + tv.tv_usec/1000000.0;
+}
+
+static void producePipe(int fd, int32_t count){
+	for(int32_t i = 1; i<=count; i++){
+		if(write(fd,&i,sizeof(int32_t))!=sizeof(int32_t)){
+			perror("write");
+			exit(-1);
+		}
+	}
+}
+
+static void consumePipe(int fd, int32_t count){
+	int32_t v;
+	for(int32_t i = 1; i<=count; i++){
+		if(read(fd,&v,sizeof(int32_t))!=sizeof(int32_t)){
+			perror("read");
+			exit(-1);
+		}
+		assert(v==i);
+	}
+}
+
+static void produce(RContainer* q, int32_t count){
+	for(int32_t i = 1; i<=count; i++){
+		q->insert(i,PRODUCER);
+	}
+}
+
+static void consume(RContainer* q, int32_t count){
+	int32_t v;
+	for(int32_t i = 1; i<=count; i++){
+		do{
+			v = q->remove(CONSUMER); // spins for LCRQ, blocks for SPDQ
+		}while(v==EMPTY);
+		assert(v==i);
+	}
+}
+
+static RContainer* build(const char* mode, ShmSegment* seg, bool create){
+	if(strcmp(mode,"lcrq")==0){
+		return new ShmLCRQ(seg,0,2,create);
+	}
+	else if(strcmp(mode,"spdq")==0){
+		return new ShmSPDQ(seg,0,2,create);
+	}
+	fprintf(stderr,"unknown mode %s\n",mode);
+	exit(-1);
+}
+
+int main(int argc, char *argv[]){
+
+	if(argc<2){
+		fprintf(stderr,"usage: %s <pipe|lcrq|spdq> [count]\n",argv[0]);
+		return -1;
+	}
+	const char* mode = argv[1];
+	int32_t count = 1000000;
+	if(argc>2){count = atoi(argv[2]);}
+
+	int fds[2];
+	ShmSegment* seg = NULL;
+	bool pipeMode = strcmp(mode,"pipe")==0;
+
+	if(pipeMode){
+		if(pipe(fds)!=0){
+			perror("pipe");
+			return -1;
+		}
+	}
+	else{
+		seg = new ShmSegment(SHM_DEFAULT_SIZE,NULL);
+		build(mode,seg,true);
+	}
+
+	double start = now();
+	pid_t pid = fork();
+	if(pid==0){
+		// consumer, remaps segment at a new address
+		if(pipeMode){
+			close(fds[1]);
+			consumePipe(fds[0],count);
+		}
+		else{
+			ShmSegment* mine = new ShmSegment(seg->getFd());
+			consume(build(mode,mine,false),count);
+		}
+		exit(0);
+	}
+
+	if(pipeMode){
+		close(fds[0]);
+		producePipe(fds[1],count);
+	}
+	else{
+		produce(build(mode,seg,false),count);
+	}
+	int status;
+	waitpid(pid,&status,0);
+	double elapsed = now()-start;
+
+	if(!WIFEXITED(status) || WEXITSTATUS(status)!=0){
+		fprintf(stderr,"consumer failed\n");
+		return -1;
+	}
+	printf("%s: %d handoffs in %f s, %ld handoffs/sec\n",mode,count,elapsed,(long)(count/elapsed));
+	return 0;
+}
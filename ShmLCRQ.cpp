@@ -0,0 +1,224 @@
+/*
+
+Copyright 2015 University of Rochester
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+
+
+#include "ShmLCRQ.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <list>
+#define __STDC_LIMIT_MACROS
+#include <stdint.h>
+
+
+ShmLCRQ::ShmLCRQ(ShmSegment* seg, int root, int t_num, bool create){
+	int i;
+	this->seg = seg;
+	task_num = t_num;
+
+	if(create){
+		uint32_t off = seg->allocRaw(sizeof(Shared));
+		uint32_t haz = seg->allocRaw(t_num*sizeof(volatile_padded<uint64_t>));
+		uint32_t pool = ShmPool<ShmCRQ>::create(seg);
+		if(off==0 || haz==0 || pool==0){
+			fprintf(stderr,"Out of memory on ShmLCRQ create!\n");
+			abort();
+		}
+		sh = (Shared*)seg->at(off);
+		sh->pool = pool;
+		sh->hazard = haz;
+		sh->task_num = t_num;
+		bp = new ShmPool<ShmCRQ>(seg,pool);
+		hazard = (volatile_padded<uint64_t>*)seg->at(haz);
+		for(i=0;i<task_num;i++){
+			hazard[i].ui=UINT64_MAX;
+		}
+
+		ShmCRQ* first = bp->alloc(0);
+		if(first==NULL){
+			fprintf(stderr,"Out of memory on ShmCRQ alloc!\n");
+			abort();
+		}
+		initRingQueue(&first->crq,0);
+		first->next = 0;
+		sh->head.off = seg->off(first);
+		sh->head.cntr = 0;
+		sh->head_index = 0;
+		sh->tail.ui = sh->head.ui;
+		sh->tail.cntr = 10;
+		__sync_synchronize();
+		seg->setRoot(root,off);
+	}
+	else{
+		sh = (Shared*)seg->at(seg->getRoot(root));
+		assert(sh!=NULL);
+		assert(sh->task_num==t_num);
+		bp = new ShmPool<ShmCRQ>(seg,sh->pool);
+		hazard = (volatile_padded<uint64_t>*)seg->at(sh->hazard);
+	}
+
+	retired = new padded<std::list<ShmCRQ*>>[t_num];
+}
+
+ShmLCRQ::~ShmLCRQ(){
+	delete[] retired;
+	delete bp;
+}
+
+void ShmLCRQ::retire(int tid, ShmCRQ* crq){
+	int i;
+	uint64_t min_hazard;
+	min_hazard = UINT64_MAX;
+	ShmCRQ* garbage;
+	for(i=0;i<task_num;i++){
+		if(hazard[i].ui<min_hazard){
+			min_hazard=hazard[i].ui;
+		}
+	}
+
+	if(min_hazard>crq->crq.index){
+		// crq is already clear,
+		// we can free it
+		bp->free(crq,tid);
+	}
+	else{
+		// crq is not clear
+		// append it to the retired list
+		retired[tid].ui.push_back(crq);
+	}
+
+	// while we're here, lets empty our retired list.
+	// The list is process local, but the hazards it is
+	// checked against are shared by every process
+	while(retired[tid].ui.size()>0 && retired[tid].ui.front()->crq.index<min_hazard){
+		garbage = retired[tid].ui.front();
+		retired[tid].ui.pop_front();
+		bp->free(garbage,tid);
+	}
+}
+
+void ShmLCRQ::releaseSlot(int tid){
+	int i;
+	uint64_t min_hazard = UINT64_MAX;
+	ShmCRQ* garbage;
+	hazard[tid].ui=UINT64_MAX;
+	for(i=0;i<task_num;i++){
+		if(hazard[i].ui<min_hazard){
+			min_hazard=hazard[i].ui;
+		}
+	}
+	// free what we can now; the rest stays on the slot's
+	// retired list for its next owner
+	while(retired[tid].ui.size()>0 && retired[tid].ui.front()->crq.index<min_hazard){
+		garbage = retired[tid].ui.front();
+		retired[tid].ui.pop_front();
+		bp->free(garbage,tid);
+	}
+}
+
+int32_t ShmLCRQ::dequeue(int tid){
+	// local variables
+	shm_cptr crq;
+	shm_cptr crq_next;
+	ShmCRQ* r;
+	int32_t v;
+
+	while(true){
+		hazard[tid].ui= sh->head_index; // see LCRQ::dequeue
+		crq.ui = sh->head.ui;
+		r = ring(crq.off);
+
+		v = crqdequeue(&r->crq);
+		if(v!= EMPTY){
+			hazard[tid].ui=UINT64_MAX; // reset our hazard index
+			return v;  // dequeued successfully, return
+		}
+		if(r->next==0){
+			hazard[tid].ui=UINT64_MAX; // reset our hazard index
+			return EMPTY; // queue is totally empty, return
+		}
+		if(!seal(&r->crq)){
+			continue;
+		}
+		crq_next.off = r->next;
+		crq_next.cntr = crq.cntr+1;
+		if(__sync_bool_compare_and_swap(&sh->head.ui, crq.ui,crq_next.ui)){
+			// same head index reclamation as LCRQ, except that
+			// hazards are published in the segment
+			__sync_fetch_and_add (&sh->head_index, 1);  // update head index
+			hazard[tid].ui=UINT64_MAX;
+			retire(tid,r);
+		}
+	}
+}
+
+void ShmLCRQ::enqueue(int32_t arg, int tid){
+	// local variables
+	shm_cptr crq;
+	shm_cptr crq_next;
+	shm_cptr newcrq;
+	ShmCRQ* r;
+	ShmCRQ* newr = NULL;
+
+	while(true){
+		hazard[tid].ui=sh->head_index; // see LCRQ::enqueue
+		crq.ui = sh->tail.ui;
+		r = ring(crq.off);
+		if(r->next!=0){
+			// tail wasn't actually the tail, try the next one and loop
+			crq_next.off = r->next;
+			crq_next.cntr = crq.cntr+1;
+			__sync_bool_compare_and_swap (&sh->tail.ui, crq.ui,crq_next.ui);
+			continue;
+		}
+		if(crqenqueue(&r->crq,arg)==OK){ // successfully enqueued
+			hazard[tid].ui=UINT64_MAX; // reset our hazard index
+			if(newr!=NULL){
+				bp->free(newr,tid);
+			}
+			return;
+		}
+		// else, the tail is closed
+		// we need to make a new tail
+		// and enqueue the arg onto it
+		if(newr==NULL){
+			newr=bp->alloc(tid);
+			if(newr==NULL){// we ran out of segment...
+				fprintf(stderr,"Out of memory on ShmCRQ alloc!\n");
+				abort();
+			}
+			initRingQueue(&newr->crq,0);
+			newr->next = 0;
+			if(crqenqueue(&newr->crq, arg)!=OK){
+				bp->free(newr,tid);
+				newr=NULL;
+				continue;
+			}
+		}
+		newr->crq.index = r->crq.index+1;
+		newcrq.off = seg->off(newr);
+		newcrq.cntr = crq.cntr+1;
+		if(__sync_bool_compare_and_swap (&(r->next), 0,newcrq.off)){//add new tail to list
+			__sync_bool_compare_and_swap (&sh->tail.ui, crq.ui,newcrq.ui); // update tail pointer
+			hazard[tid].ui=UINT64_MAX; // reset our hazard index
+			return;
+		}
+	}
+}
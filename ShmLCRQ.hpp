@@ -0,0 +1,115 @@
+/*
+
+Copyright 2015 University of Rochester
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+
+
+#ifndef SHM_LCRQ_H
+#define SHM_LCRQ_H
+
+#ifndef _REENTRANT
+#define _REENTRANT		/* basic 3-lines for threads */
+#endif
+
+#include <stdint.h>
+#include <list>
+#include "ConcurrentPrimitives.hpp"
+#include "RContainer.hpp"
+#include "LCRQ.hpp"
+#include "ShmSegment.hpp"
+#include "ThreadRegistry.hpp"
+
+
+// Linked circular ring queue living entirely inside a
+// ShmSegment, so that several processes can share it.
+// The rings themselves are ordinary CRQs operated on by
+// crqenqueue/crqdequeue; only the links between rings,
+// the head and tail pointers, and the hazard array are
+// expressed as segment offsets.
+
+// a CRQ plus its in-segment link.  crq.next is unused.
+struct ShmCRQ{
+	struct CRQ crq;
+	volatile uint32_t next; // offset of next ShmCRQ, 0 if none
+	char pad1[LEVEL1_DCACHE_LINESIZE-sizeof(uint32_t)];
+};
+
+class ShmLCRQ: public virtual RQueue, public Reportable, public SlotOwner{
+
+	// shared state, at offset getRoot(root) in the segment
+	struct Shared{
+		shm_cptr head;
+		char pad1[LEVEL1_DCACHE_LINESIZE-sizeof(shm_cptr)];
+		shm_cptr tail;
+		char pad2[LEVEL1_DCACHE_LINESIZE-sizeof(shm_cptr)];
+		volatile uint64_t head_index;
+		char pad3[LEVEL1_DCACHE_LINESIZE-sizeof(uint64_t)];
+		uint32_t pool; // offset of ring pool state
+		uint32_t hazard; // offset of hazard array
+		int task_num;
+	};
+
+	ShmSegment* seg;
+	Shared* sh;
+	volatile_padded<uint64_t>* hazard; // in segment
+	padded<std::list<ShmCRQ*>>* retired; // process local
+	ShmPool<ShmCRQ>* bp;
+	int task_num;
+
+	inline ShmCRQ* ring(uint32_t off){return (ShmCRQ*)seg->at(off);}
+	void retire(int tid, ShmCRQ* crq);
+
+public:
+	// create == true builds a new queue in seg and publishes it
+	// as root number root; otherwise attaches to the queue
+	// already published there.  Each process must use
+	// distinct tids in [0,task_num).
+	ShmLCRQ(ShmSegment* seg, int root, int task_num, bool create);
+	~ShmLCRQ();
+
+	int32_t dequeue(int tid);
+	void enqueue(int32_t arg, int tid);
+	void releaseSlot(int tid);
+
+	void conclude(){
+		int i = 0;
+		while(this->remove(i%task_num)!=EMPTY){
+			i++;
+		}
+		std::cout<<"size@End="<<i<<std::endl;
+	}
+};
+
+
+// the segments outlive the queues built in them,
+// so they go when the factory does
+class ShmLCRQFactory : public RContainerFactory{
+	std::list<ShmSegment*> segs;
+public:
+	ShmLCRQ* build(GlobalTestConfig* gtc){
+		ShmSegment* seg = new ShmSegment(SHM_DEFAULT_SIZE,NULL);
+		segs.push_back(seg);
+		return new ShmLCRQ(seg,0,gtc->task_num,true);
+	}
+	~ShmLCRQFactory(){
+		for(std::list<ShmSegment*>::iterator i = segs.begin(); i!=segs.end(); i++){
+			delete *i;
+		}
+	}
+};
+
+#endif
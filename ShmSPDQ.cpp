@@ -0,0 +1,349 @@
+/*
+
+Copyright 2015 University of Rochester
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+
+
+#include "ShmSPDQ.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <list>
+#define __STDC_LIMIT_MACROS
+#include <stdint.h>
+
+
+ShmSPDQ::ShmSPDQ(ShmSegment* seg, int root, int t_num, bool create){
+	int i;
+	this->seg = seg;
+	task_num = t_num;
+
+	if(create){
+		uint32_t off = seg->allocRaw(sizeof(Shared));
+		uint32_t haz = seg->allocRaw(t_num*sizeof(volatile_padded<uint64_t>));
+		uint32_t wait = seg->allocRaw(t_num*sizeof(padded<SPDQ::DCRQ_wait>));
+		uint32_t pool = ShmPool<ShmDCRQ>::create(seg);
+		if(off==0 || haz==0 || wait==0 || pool==0){
+			fprintf(stderr,"Out of memory on ShmSPDQ create!\n");
+			abort();
+		}
+		sh = (Shared*)seg->at(off);
+		sh->pool = pool;
+		sh->hazard = haz;
+		sh->waiters = wait;
+		sh->task_num = t_num;
+		bp = new ShmPool<ShmDCRQ>(seg,pool);
+		hazard = (volatile_padded<uint64_t>*)seg->at(haz);
+		waiters = (padded<SPDQ::DCRQ_wait>*)seg->at(wait);
+		for(i=0;i<task_num;i++){
+			hazard[i].ui=UINT64_MAX;
+			waiters[i].ui.set(0,1);
+		}
+
+		ShmDCRQ* first = bp->alloc(0);
+		if(first==NULL){
+			fprintf(stderr,"Out of memory on ShmDCRQ alloc!\n");
+			abort();
+		}
+		initRingQueue(&first->crq,0);
+		first->next = 0;
+		first->antidata = ANTIDATA;
+		sh->head.off = seg->off(first);
+		sh->head.cntr = 0;
+		sh->head_index = 0;
+		sh->tail.ui = sh->head.ui;
+		__sync_synchronize();
+		seg->setRoot(root,off);
+	}
+	else{
+		sh = (Shared*)seg->at(seg->getRoot(root));
+		assert(sh!=NULL);
+		assert(sh->task_num==t_num);
+		bp = new ShmPool<ShmDCRQ>(seg,sh->pool);
+		hazard = (volatile_padded<uint64_t>*)seg->at(sh->hazard);
+		waiters = (padded<SPDQ::DCRQ_wait>*)seg->at(sh->waiters);
+	}
+
+	retired = new padded<std::list<ShmDCRQ*>>[t_num];
+}
+
+ShmSPDQ::~ShmSPDQ(){
+	delete[] retired;
+	delete bp;
+}
+
+void ShmSPDQ::retire(int tid, ShmDCRQ* dcrq){
+	int i;
+	uint64_t min_hazard;
+	min_hazard = UINT64_MAX;
+	ShmDCRQ* garbage;
+	for(i=0;i<task_num;i++){
+		if(hazard[i].ui<min_hazard){
+			min_hazard=hazard[i].ui;
+		}
+	}
+
+	if(min_hazard>dcrq->crq.index){
+		bp->free(dcrq,tid);
+	}
+	else{
+		retired[tid].ui.push_back(dcrq);
+	}
+
+	while(retired[tid].ui.size()>0 && retired[tid].ui.front()->crq.index<min_hazard){
+		garbage = retired[tid].ui.front();
+		retired[tid].ui.pop_front();
+		bp->free(garbage,tid);
+	}
+}
+
+void ShmSPDQ::releaseSlot(int tid){
+	int i;
+	uint64_t min_hazard = UINT64_MAX;
+	ShmDCRQ* garbage;
+	hazard[tid].ui=UINT64_MAX;
+	for(i=0;i<task_num;i++){
+		if(hazard[i].ui<min_hazard){
+			min_hazard=hazard[i].ui;
+		}
+	}
+	// free what we can now; the rest stays on the slot's
+	// retired list for its next owner
+	while(retired[tid].ui.size()>0 && retired[tid].ui.front()->crq.index<min_hazard){
+		garbage = retired[tid].ui.front();
+		retired[tid].ui.pop_front();
+		bp->free(garbage,tid);
+	}
+}
+
+// allocate a fresh ring of the given polarity
+// holding arg as its only element
+ShmDCRQ* ShmSPDQ::newRing(bool antidata, int32_t arg, int tid){
+	ShmDCRQ* r = bp->alloc(tid);
+	if(r==NULL){// we ran out of segment...
+		fprintf(stderr,"Out of memory on ShmDCRQ alloc!\n");
+		abort();
+	}
+	initRingQueue(&r->crq,0);
+	r->next = 0;
+	r->antidata = antidata;
+	if(crqenqueue(&r->crq,arg)!=OK){
+		assert(false);
+	}
+	return r;
+}
+
+int32_t ShmSPDQ::_dequeue(bool antidata, int32_t arg, int tid){
+	// local variables
+	shm_cptr dcrq;
+	ShmDCRQ* r;
+	ShmDCRQ* newr = NULL;
+	int32_t v;
+	SPDQ::DCRQ_wait* w = &(waiters[tid].ui);
+	int32_t mine;
+
+	while(true){
+		hazard[tid].ui= sh->head_index; // see SPDQ::_dequeue
+		dcrq.ui = sh->head.ui;
+		r = ring(dcrq.off);
+		if(r->antidata==antidata){
+			// then head changed beneath us
+			hazard[tid].ui=UINT64_MAX;
+			if(newr!=NULL){bp->free(newr,tid);}
+			return EMPTY;
+		}
+
+		v = crqdequeue(&r->crq); // dequeue from head
+		if(v!=EMPTY){
+			hazard[tid].ui=UINT64_MAX; // reset our hazard index
+			if(newr!=NULL){bp->free(newr,tid);}
+			if(antidata==DATA){
+				// we own the waiter we removed, so no CAS is needed
+				waiter(v)->set(arg,1);
+				return OK;
+			}
+			return v;  // dequeued successfully, return
+		}
+		// seal empty ring so we can remove it
+		else if(!seal(&r->crq)){
+			hazard[tid].ui=UINT64_MAX;
+			continue;
+		}
+
+		// at this point head ring is sealed
+		// we need to add a tail
+		// of our polarity
+		if(r->next==0){
+			if(newr==NULL){
+				if(antidata){
+					mine = seg->off(w);
+					w->set(0,0);
+				}
+				else{
+					mine = arg;
+				}
+				newr = newRing(antidata,mine,tid);
+			}
+			newr->crq.index = r->crq.index+1;
+			if(appendRing(r,newr)){
+				swingHead(dcrq,tid);
+				hazard[tid].ui=UINT64_MAX;
+				if(antidata){
+					while(!w->is_sat()){}
+					return w->val();
+				}
+				return OK;
+			}
+		}
+		else{
+			// the head is sealed, but has a next, so swing it and try again
+			swingHead(dcrq,tid);
+			hazard[tid].ui=UINT64_MAX;
+		}
+	}
+}
+
+int32_t ShmSPDQ::_enqueue(shm_cptr h, bool antidata, int32_t arg, int tid){
+	// local variables
+	shm_cptr dcrq;
+	shm_cptr dcrq_next;
+	ShmDCRQ* r;
+	ShmDCRQ* newr = NULL;
+
+	while(true){
+		hazard[tid].ui=sh->head_index; // see SPDQ::_enqueue
+		dcrq.ui = sh->tail.ui;
+		r = ring(dcrq.off);
+		if(r->next!=0){
+			// tail wasn't actually the tail, try the next one and loop
+			dcrq_next.off = r->next;
+			dcrq_next.cntr = dcrq.cntr+1;
+			__sync_bool_compare_and_swap (&sh->tail.ui, dcrq.ui,dcrq_next.ui);
+			continue;
+		}
+		if(r->antidata!=antidata){
+			// enqueueing wrong polarity (head is out of date)
+			// that means it must be sealed, or I am out of date
+			if(sh->head.ui==h.ui && seal(&ring(h.off)->crq)){
+				swingHead(h,tid);
+			}
+			hazard[tid].ui=UINT64_MAX;
+			if(newr!=NULL){bp->free(newr,tid);}
+			return CLOSED;
+		}
+		if(crqenqueue(&r->crq,arg)==OK){ // successfully enqueued
+			hazard[tid].ui=UINT64_MAX;
+			if(newr!=NULL){bp->free(newr,tid);}
+			return OK;
+		}
+		// else, the tail is closed
+		// we need to make a new tail
+		// and enqueue the arg onto it
+		if(newr==NULL){
+			newr = newRing(antidata,arg,tid);
+		}
+		newr->crq.index = r->crq.index+1;
+		if(appendRing(r,newr)){
+			hazard[tid].ui=UINT64_MAX; // reset our hazard index
+			return OK;
+		}
+	}
+}
+
+// head must be sealed prior to calling this
+bool ShmSPDQ::swingHead(shm_cptr h, int tid){
+	shm_cptr dcrq_next;
+	ShmDCRQ* r = ring(h.off);
+	if(sh->head.ui!=h.ui || r->next==0){
+		return false;
+	}
+	dcrq_next.off = r->next;
+	dcrq_next.cntr = h.cntr+1;
+	if(__sync_bool_compare_and_swap(&sh->head.ui, h.ui,dcrq_next.ui)){
+		__sync_fetch_and_add (&sh->head_index, 1);  // update head index
+		retire(tid,r);
+		return true;
+	}
+	return false;
+}
+
+bool ShmSPDQ::appendRing(ShmDCRQ* prev, ShmDCRQ* next){
+	shm_cptr t;
+	shm_cptr newt;
+	uint32_t off = seg->off(next);
+	if(__sync_bool_compare_and_swap (&(prev->next), 0,off)){//add new tail to list
+		t.ui = sh->tail.ui;
+		if(t.off==seg->off(prev)){
+			newt.off = off;
+			newt.cntr = t.cntr+1;
+			__sync_bool_compare_and_swap (&sh->tail.ui, t.ui,newt.ui); // update tail pointer
+		}
+		return true;
+	}
+	return false;
+}
+
+int32_t ShmSPDQ::remove(int tid){
+	shm_cptr dcrq;
+	int32_t v;
+
+	// keep trying to operate on queue
+	while(true){
+		dcrq.ui = sh->head.ui;
+		// if head polarity matches operation polarity (holds -), enqueue
+		if(ring(dcrq.off)->antidata == ANTIDATA){
+			SPDQ::DCRQ_wait* w = &(waiters[tid].ui);
+			w->set(0,0);
+			v = _enqueue(dcrq, ANTIDATA, seg->off(w), tid);
+			if(v==OK){
+				while(!w->is_sat()){}
+				return w->val();
+			}
+		}
+		// else, dequeue
+		else{
+			v = _dequeue(ANTIDATA, 0, tid);
+			if(v!=EMPTY){
+				return v;
+			}
+		}
+	}
+}
+
+void ShmSPDQ::insert(int32_t arg, int tid){
+	shm_cptr dcrq;
+	int32_t v;
+
+	// keep trying to operate on head
+	while(true){
+		dcrq.ui = sh->head.ui;
+		// if head polarity matches operation polarity (holds +), enqueue
+		if(ring(dcrq.off)->antidata == DATA){
+			v = _enqueue(dcrq, DATA, arg, tid);
+			if(v==OK){
+				return;
+			}
+		}
+		else{
+			v = _dequeue(DATA, arg, tid);
+			if(v!=EMPTY){
+				return;
+			}
+		}
+	}
+}
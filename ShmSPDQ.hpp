@@ -0,0 +1,122 @@
+/*
+
+Copyright 2015 University of Rochester
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+
+
+#ifndef SHM_SPDQ_H
+#define SHM_SPDQ_H
+
+#ifndef _REENTRANT
+#define _REENTRANT		/* basic 3-lines for threads */
+#endif
+
+#include <stdint.h>
+#include <list>
+#include "RDualContainer.hpp"
+#include "LCRQ.hpp"
+#include "SPDQ.hpp"
+#include "ShmSegment.hpp"
+#include "ThreadRegistry.hpp"
+
+
+// Single polarity dual ring queue living entirely inside
+// a ShmSegment.  Follows SPDQ (blocking variant only),
+// but rings are ordinary CRQs, and waiters are published
+// in the rings as segment offsets rather than pointers, so
+// a producer in one process can satisfy a consumer
+// in another regardless of where each mapped the segment.
+//
+// Since only one producer can ever dequeue a given waiter
+// from a CRQ, the waiter's tag (the node address in SPDQ,
+// used for the lock free variant) is unnecessary here.
+
+// a CRQ plus its in-segment link and polarity.  crq.next is unused.
+struct ShmDCRQ{
+	struct CRQ crq;
+	volatile uint32_t next; // offset of next ShmDCRQ, 0 if none
+	char pad1[LEVEL1_DCACHE_LINESIZE-sizeof(uint32_t)];
+	bool antidata;
+	char pad2[LEVEL1_DCACHE_LINESIZE-sizeof(bool)];
+};
+
+class ShmSPDQ: public virtual RDualContainer, public SlotOwner{
+
+	// shared state, at offset getRoot(root) in the segment
+	struct Shared{
+		shm_cptr head;
+		char pad1[LEVEL1_DCACHE_LINESIZE-sizeof(shm_cptr)];
+		shm_cptr tail;
+		char pad2[LEVEL1_DCACHE_LINESIZE-sizeof(shm_cptr)];
+		volatile uint64_t head_index;
+		char pad3[LEVEL1_DCACHE_LINESIZE-sizeof(uint64_t)];
+		uint32_t pool; // offset of ring pool state
+		uint32_t hazard; // offset of hazard array
+		uint32_t waiters; // offset of waiter array
+		int task_num;
+	};
+
+	ShmSegment* seg;
+	Shared* sh;
+	volatile_padded<uint64_t>* hazard; // in segment
+	padded<SPDQ::DCRQ_wait>* waiters; // in segment
+	padded<std::list<ShmDCRQ*>>* retired; // process local
+	ShmPool<ShmDCRQ>* bp;
+	int task_num;
+
+	inline ShmDCRQ* ring(uint32_t off){return (ShmDCRQ*)seg->at(off);}
+	inline SPDQ::DCRQ_wait* waiter(uint32_t off){return (SPDQ::DCRQ_wait*)seg->at(off);}
+	ShmDCRQ* newRing(bool antidata, int32_t arg, int tid);
+
+	int32_t _dequeue(bool antidata, int32_t arg, int tid);
+	int32_t _enqueue(shm_cptr h, bool antidata, int32_t arg, int tid);
+	bool swingHead(shm_cptr h, int tid);
+	bool appendRing(ShmDCRQ* prev, ShmDCRQ* next);
+	void retire(int tid, ShmDCRQ* dcrq);
+
+public:
+	// create == true builds a new queue in seg and publishes it
+	// as root number root; otherwise attaches to the queue
+	// already published there.  Each process must use
+	// distinct tids in [0,task_num).
+	ShmSPDQ(ShmSegment* seg, int root, int task_num, bool create);
+	~ShmSPDQ();
+
+	int32_t remove(int tid);
+	void insert(int32_t arg, int tid);
+	void releaseSlot(int tid);
+};
+
+
+// the segments outlive the queues built in them,
+// so they go when the factory does
+class ShmSPDQFactory : public RContainerFactory{
+	std::list<ShmSegment*> segs;
+public:
+	ShmSPDQ* build(GlobalTestConfig* gtc){
+		ShmSegment* seg = new ShmSegment(SHM_DEFAULT_SIZE,NULL);
+		segs.push_back(seg);
+		return new ShmSPDQ(seg,0,gtc->task_num,true);
+	}
+	~ShmSPDQFactory(){
+		for(std::list<ShmSegment*>::iterator i = segs.begin(); i!=segs.end(); i++){
+			delete *i;
+		}
+	}
+};
+
+#endif
@@ -0,0 +1,227 @@
+/*
+
+Copyright 2015 University of Rochester
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+
+
+#ifndef SHM_SEGMENT_HPP
+#define SHM_SEGMENT_HPP
+
+#ifndef _REENTRANT
+#define _REENTRANT		/* basic 3-lines for threads */
+#endif
+
+#include <stdint.h>
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <atomic>
+#include "ConcurrentPrimitives.hpp"
+
+#define SHM_DEFAULT_SIZE (64*1024*1024)
+#define SHM_MAGIC 0x44514d53
+#define SHM_ROOTS 8
+
+
+// A shared memory segment (memfd or file backed) that
+// can be mapped by several processes, each possibly
+// at a different address.  Anything stored inside the
+// segment must refer to other in-segment objects by
+// offset from the segment base.  Offset 0 is the header,
+// so we use it as NULL.
+class ShmSegment{
+public:
+
+	// lives at offset 0 of the segment
+	struct Header{
+		uint32_t magic;
+		uint32_t size;
+		std::atomic<uint32_t> brk; // bump allocation frontier
+		std::atomic<uint32_t> roots[SHM_ROOTS]; // well known objects for attaching processes
+	};
+
+private:
+	char* base;
+	uint32_t sz;
+	int fd;
+	bool created; // we opened fd, so we close it
+
+	void map(){
+		base = (char*)mmap(NULL,sz,PROT_READ|PROT_WRITE,MAP_SHARED,fd,0);
+		if(base==MAP_FAILED){
+			perror("mmap");
+			abort();
+		}
+	}
+
+public:
+
+	// create a new segment.  If path is NULL the segment is
+	// anonymous (memfd), and can be shared with children
+	// across fork or through /proc/<pid>/fd/<fd>
+	ShmSegment(uint32_t size, const char* path){
+		if(path==NULL){
+			fd = memfd_create("dqs_shm",0);
+		}
+		else{
+			fd = open(path,O_RDWR|O_CREAT|O_TRUNC,0600);
+		}
+		if(fd<0 || ftruncate(fd,size)!=0){
+			perror("shm segment create");
+			abort();
+		}
+		created = true;
+		sz = size;
+		map();
+		Header* h = header();
+		h->size = size;
+		h->brk.store(sizeof(Header));
+		for(int i = 0; i<SHM_ROOTS; i++){
+			h->roots[i].store(0);
+		}
+		h->magic = SHM_MAGIC;
+		std::atomic_thread_fence(std::memory_order_release);
+	}
+
+	// attach to an existing segment through an open descriptor.
+	// The mapping is new, so generally lands at a different
+	// address than the creator's
+	ShmSegment(int fd){
+		struct stat st;
+		this->fd = fd;
+		created = false;
+		if(fstat(fd,&st)!=0){
+			perror("shm segment attach");
+			abort();
+		}
+		sz = st.st_size;
+		map();
+		assert(header()->magic==SHM_MAGIC);
+		assert(header()->size==sz);
+	}
+
+	~ShmSegment(){
+		munmap(base,sz);
+		if(created){
+			close(fd);
+		}
+	}
+
+	inline Header* header(){return (Header*)base;}
+	inline void* at(uint32_t off){
+		if(off==0){return NULL;}
+		return (void*)(base+off);
+	}
+	inline uint32_t off(const void* p){
+		if(p==NULL){return 0;}
+		assert((char*)p>base && (char*)p<base+sz);
+		return (uint32_t)((char*)p-base);
+	}
+	int getFd(){return fd;}
+	uint32_t size(){return sz;}
+
+	void setRoot(int i, uint32_t off){header()->roots[i].store(off,std::memory_order_release);}
+	uint32_t getRoot(int i){return header()->roots[i].load(std::memory_order_acquire);}
+
+	// cache line aligned bump allocation, never freed.
+	// returns 0 if segment is exhausted
+	uint32_t allocRaw(uint32_t bytes){
+		bytes = ((bytes+LEVEL1_DCACHE_LINESIZE-1)/LEVEL1_DCACHE_LINESIZE)*LEVEL1_DCACHE_LINESIZE;
+		uint32_t old = header()->brk.load();
+		uint32_t start;
+		while(true){
+			start = ((old+LEVEL1_DCACHE_LINESIZE-1)/LEVEL1_DCACHE_LINESIZE)*LEVEL1_DCACHE_LINESIZE;
+			if(start+bytes>sz || start+bytes<start){return 0;}
+			if(header()->brk.compare_exchange_strong(old,start+bytes)){break;}
+		}
+		return start;
+	}
+};
+
+// counted offset, the in-segment analogue of CRQ_ptr
+struct shm_cptr{
+	union{
+		volatile uint64_t ui;
+		struct{
+			volatile uint32_t cntr;
+			volatile uint32_t off;
+		};
+	};
+};
+
+
+// In-segment pool of fixed size blocks.  Free blocks
+// are kept on a Treiber stack of offsets whose top is
+// counted to avoid ABA.  Blocks are never returned to the
+// segment, so reading a stale link is harmless.
+// Matches BlockPool's alloc/free interface.
+template <class T>
+class ShmPool{
+	struct State{
+		std::atomic<uint64_t> top; // hi: count, lo: offset of first free block
+	};
+	struct FreeBlock{
+		std::atomic<uint32_t> next;
+	};
+
+	ShmSegment* seg;
+	State* st;
+
+public:
+	// allocates pool state in the segment, returns its offset
+	static uint32_t create(ShmSegment* seg){
+		uint32_t off = seg->allocRaw(sizeof(State));
+		if(off==0){return 0;}
+		((State*)seg->at(off))->top.store(0);
+		return off;
+	}
+
+	ShmPool(ShmSegment* seg, uint32_t state_off){
+		this->seg = seg;
+		this->st = (State*)seg->at(state_off);
+	}
+
+	T* alloc(int tid){
+		uint64_t old = st->top.load(std::memory_order_acquire);
+		while((uint32_t)old!=0){
+			FreeBlock* b = (FreeBlock*)seg->at((uint32_t)old);
+			uint64_t next = ((old>>32)+1)<<32 | b->next.load(std::memory_order_relaxed);
+			if(st->top.compare_exchange_weak(old,next)){
+				return (T*)b;
+			}
+		}
+		return (T*)seg->at(seg->allocRaw(sizeof(T)));
+	}
+
+	void free(T* p, int tid){
+		FreeBlock* b = (FreeBlock*)p;
+		uint32_t off = seg->off(p);
+		uint64_t old = st->top.load(std::memory_order_acquire);
+		while(true){
+			b->next.store((uint32_t)old,std::memory_order_relaxed);
+			uint64_t next = ((old>>32)+1)<<32 | off;
+			if(st->top.compare_exchange_weak(old,next)){break;}
+		}
+	}
+};
+
+#endif
@@ -0,0 +1,303 @@
+/*
+
+Copyright 2015 University of Rochester
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+
+
+// Lock-free skiplist priority queue.
+//
+// See:
+//   J. Lindén and B. Jonsson. A skiplist-based concurrent
+//   priority queue with minimal memory contention. OPODIS 2013.
+// 
+
+
+#include <iostream>
+#include "RContainer.hpp"
+#include "SkipListPriorityQueue.hpp"
+
+using namespace std;
+
+SkipListPriorityQueue::SkipListPriorityQueue(int task_num, bool glibc_mem){
+	this->task_num = task_num;
+	bp = new BlockPool<Node>(task_num,glibc_mem);
+	reclaimer = new EpochReclaimer<Node>(task_num,bp,64);
+	head = bp->alloc(0);
+	head->key = 0;
+	head->level = MAX_LEVEL;
+	head->inserting.store(false);
+	for(int i = 0; i<MAX_LEVEL; i++){
+		head->next[i].store(word(false,NULL,0));
+	}
+	seeds = new padded<uint32_t>[task_num];
+	for(int i = 0; i<task_num; i++){
+		seeds[i].ui = i+1;
+	}
+}
+
+void SkipListPriorityQueue::conclude(){
+	cout<<"retired@Peak="<<reclaimer->retiredPeak()
+	  <<" ("<<reclaimer->retiredPeak()*sizeof(Node)/1024<<"KB)"<<endl;
+	int i = 0;
+	while(this->remove(0)!=EMPTY){
+		i++;
+	}
+	cout<<"size@End="<<i<<endl;
+}
+
+// geometric with p=1/2, in [1,MAX_LEVEL]
+int SkipListPriorityQueue::randomLevel(int tid){
+	uint32_t x = seeds[tid].ui;
+	x ^= x<<13;
+	x ^= x>>17;
+	x ^= x<<5;
+	seeds[tid].ui = x;
+	int l = __builtin_ctz(x|(1<<(MAX_LEVEL-1)))+1;
+	return l;
+}
+
+// only for words nobody else can write yet; keeps the
+// sequence number running across reuse of the block
+void SkipListPriorityQueue::setNext(Node* n, int i, Node* p){
+	n->next[i].store(word(false,p,sn(n->next[i].load())+1));
+}
+
+// Fills preds and succs (the successor words) at every level for
+// an insert of k.  Nodes whose own bottom word is marked are in the
+// deleted prefix and skipped on every level; on the bottom level the
+// walk also passes the node a marked word points to, so preds[0] is
+// the last deleted node at best.  Returns the last deleted node seen.
+SkipListPriorityQueue::Node* SkipListPriorityQueue::locatePreds(int32_t k, Node** preds, uint64_t* succs){
+	Node* x = head;
+	Node* del = NULL;
+	Node* cur;
+	uint64_t w;
+	bool d;
+	for(int i = MAX_LEVEL-1; i>=0; i--){
+		w = x->next[i].load();
+		d = marked(w);
+		cur = ptr(w);
+		while(cur!=NULL && (cur->key<k || marked(cur->next[0].load()) || (i==0 && d))){
+			if(d && i==0){del = cur;}
+			x = cur;
+			w = x->next[i].load();
+			d = marked(w);
+			cur = ptr(w);
+		}
+		preds[i] = x;
+		succs[i] = w;
+	}
+	return del;
+}
+
+void SkipListPriorityQueue::insert(int32_t e, int tid){
+	Node* preds[MAX_LEVEL];
+	uint64_t succs[MAX_LEVEL];
+	uint64_t expected;
+	Node* del;
+	Node* s;
+
+	Node* node = bp->alloc(tid);
+	reclaimer->onAlloc(node,tid);
+	node->seq++;
+	node->key = e;
+	node->level = randomLevel(tid);
+	node->inserting.store(true);
+
+	reclaimer->begin(tid,0);
+	while(true){
+		del = locatePreds(e,preds,succs);
+		setNext(node,0,ptr(succs[0]));
+		expected = succs[0];
+		if(!marked(expected) && preds[0]->next[0].compare_exchange_strong(expected,
+		  word(false,node,sn(expected)+1))){
+			break;
+		}
+	}
+
+	// upper levels are only a shortcut; give up on them
+	// once the node, or its successor, has been deleted
+	for(int i = 1; i<node->level;){
+		s = ptr(succs[i]);
+		setNext(node,i,s);
+		if(marked(node->next[0].load()) || (s!=NULL && (marked(s->next[0].load()) || s==del))){
+			break;
+		}
+		expected = succs[i];
+		if(preds[i]->next[i].compare_exchange_strong(expected,word(false,node,sn(expected)+1))){
+			i++;
+		}
+		else{
+			del = locatePreds(e,preds,succs);
+			if(ptr(succs[0])!=node){
+				break;
+			}
+		}
+	}
+	node->inserting.store(false);
+	reclaimer->end(tid);
+}
+
+int32_t SkipListPriorityQueue::remove(int tid){
+	Node* x = head;
+	Node* newhead = NULL;
+	Node* n;
+	int offset = 0;
+	uint64_t w;
+	int32_t val = EMPTY;
+
+	reclaimer->begin(tid,0);
+	uint64_t obs_head = head->next[0].load();
+	while(true){
+		w = x->next[0].load();
+		n = ptr(w);
+		if(n==NULL){
+			break;
+		}
+		if(newhead==NULL && x->inserting.load()){
+			newhead = x;
+		}
+		if(marked(w)){
+			offset++;
+			x = n;
+			continue;
+		}
+		// claim n by marking the word that points to it
+		if(x->next[0].compare_exchange_strong(w,w|MARK)){
+			val = n->key;
+			offset++;
+			cutPrefix(obs_head,newhead!=NULL?newhead:n,offset,tid);
+			break;
+		}
+	}
+	reclaimer->end(tid);
+	return val;
+}
+
+KeyVal SkipListPriorityQueue::peek(int tid){
+	KeyVal kv;
+	Node* x = head;
+	Node* n;
+	uint64_t w;
+
+	reclaimer->begin(tid,0);
+	while(true){
+		w = x->next[0].load();
+		n = ptr(w);
+		if(n==NULL){
+			kv.key = 0;
+			kv.val = EMPTY;
+			break;
+		}
+		if(marked(w)){
+			x = n;
+			continue;
+		}
+		kv.key = ((uint64_t)n->seq<<32)|(uint32_t)n;
+		kv.val = n->key;
+		break;
+	}
+	reclaimer->end(tid);
+	return kv;
+}
+
+// deletes the node peek() saw only if it is still the first live
+// one: the mark CAS fails if anything was inserted ahead of it
+bool SkipListPriorityQueue::remove_cond(uint64_t key, int tid){
+	Node* target = (Node*)(uint32_t)key;
+	uint32_t seq = key>>32;
+	Node* x = head;
+	Node* newhead = NULL;
+	Node* n;
+	int offset = 0;
+	uint64_t w;
+	bool ret = false;
+
+	reclaimer->begin(tid,0);
+	uint64_t obs_head = head->next[0].load();
+	while(true){
+		w = x->next[0].load();
+		n = ptr(w);
+		if(n==NULL){
+			break;
+		}
+		if(newhead==NULL && x->inserting.load()){
+			newhead = x;
+		}
+		if(marked(w)){
+			offset++;
+			x = n;
+			continue;
+		}
+		if(n==target && n->seq==seq && x->next[0].compare_exchange_strong(w,w|MARK)){
+			ret = true;
+			offset++;
+			cutPrefix(obs_head,newhead!=NULL?newhead:n,offset,tid);
+		}
+		break;
+	}
+	reclaimer->end(tid);
+	return ret;
+}
+
+// Once a remover has walked more than BOUND_OFFSET deleted nodes,
+// points head at newhead if head hasn't moved since obs_head was
+// read, and retires everything in between.  newhead is deleted
+// itself, so head's word stays marked.
+void SkipListPriorityQueue::cutPrefix(uint64_t obs_head, Node* newhead, int offset, int tid){
+	if(offset<=BOUND_OFFSET || ptr(obs_head)==newhead){
+		return;
+	}
+	if(head->next[0].load()!=obs_head){
+		return;
+	}
+	if(!head->next[0].compare_exchange_strong(obs_head,word(true,newhead,sn(obs_head)+1))){
+		return;
+	}
+	restructure();
+	Node* cur = ptr(obs_head);
+	Node* next;
+	while(cur!=newhead){
+		next = ptr(cur->next[0].load());
+		reclaimer->retire(cur,tid);
+		cur = next;
+	}
+}
+
+// moves head's upper levels past nodes in the deleted prefix
+void SkipListPriorityQueue::restructure(){
+	Node* pred = head;
+	uint64_t h;
+	uint64_t w;
+	Node* hn;
+	for(int i = MAX_LEVEL-1; i>0;){
+		h = head->next[i].load();
+		hn = ptr(h);
+		if(hn==NULL || !marked(hn->next[0].load())){
+			i--;
+			continue;
+		}
+		w = pred->next[i].load();
+		while(ptr(w)!=NULL && marked(ptr(w)->next[0].load())){
+			pred = ptr(w);
+			w = pred->next[i].load();
+		}
+		if(head->next[i].compare_exchange_strong(h,word(false,ptr(w),sn(h)+1))){
+			i--;
+		}
+	}
+}
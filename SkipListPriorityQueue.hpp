@@ -0,0 +1,111 @@
+/*
+
+Copyright 2015 University of Rochester
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+
+
+// Lock-free skiplist priority queue.
+//
+// See:
+//   J. Lindén and B. Jonsson. A skiplist-based concurrent
+//   priority queue with minimal memory contention. OPODIS 2013.
+//
+// Inserts are O(log n) where MichaelPriorityQueue walks the
+// whole list.  Deletion is logical: a node is removed by setting
+// the mark bit in its predecessor's bottom level next word, so
+// the deleted nodes form a prefix of the bottom level and a
+// deleteMin is one CAS on the first unmarked word.  Only once the
+// prefix grows past BOUND_OFFSET does a remover swing head past
+// it, fix the upper levels and retire the nodes, so removers
+// rarely write to the same line.  Nodes still being linked into
+// the upper levels are never cut off; they and everything after
+// them stay until a later pass.
+//
+// Values are their own priorities, smallest first.  Next words
+// carry a sequence number beside the pointer, and peek()'s key
+// names the first live node by address and incarnation, so
+// remove_cond() succeeds only if that node is still the minimum.
+// Retired nodes are freed through an EpochReclaimer.
+
+
+#ifndef SKIPLIST_PRIORITY_QUEUE_H
+#define SKIPLIST_PRIORITY_QUEUE_H
+
+#include <atomic>
+#include "RDualContainer.hpp"
+#include "BlockPool.hpp"
+#include "Reclaimer.hpp"
+
+class SkipListPriorityQueue : public virtual RPeekableContainer, public virtual RPriorityQueue, public Reportable{
+
+	// enough for 16M nodes
+	static const int MAX_LEVEL = 24;
+	// deleted nodes tolerated before the prefix is cut
+	static const int BOUND_OFFSET = 32;
+
+	class Node{
+	public:
+		int32_t key;
+		int level;
+		uint32_t seq; // bumped each time the block is reused
+		std::atomic<bool> inserting;
+		Node* retired_next; // reclamation bookkeeping, see Reclaimer.hpp
+		uint64_t birth_era;
+		uint64_t retire_era;
+		std::atomic<uint64_t> next[MAX_LEVEL];
+	};
+
+	// next word: mark in the top bit, sequence number
+	// in the next 31, the pointer in the low 32
+	static const uint64_t MARK = 0x8000000000000000ULL;
+	static inline Node* ptr(uint64_t w){return (Node*)(uint32_t)w;}
+	static inline bool marked(uint64_t w){return (w&MARK)!=0;}
+	static inline uint32_t sn(uint64_t w){return (w>>32)&0x7fffffff;}
+	static inline uint64_t word(bool m, Node* p, uint32_t s){
+		return (m?MARK:0)|((uint64_t)(s&0x7fffffff)<<32)|(uint32_t)p;
+	}
+
+	Node* head;
+	padded<uint32_t>* seeds;
+	BlockPool<Node>* bp;
+	Reclaimer<Node>* reclaimer;
+	int task_num;
+
+	int randomLevel(int tid);
+	void setNext(Node* n, int i, Node* p);
+	Node* locatePreds(int32_t k, Node** preds, uint64_t* succs);
+	void cutPrefix(uint64_t obs_head, Node* newhead, int offset, int tid);
+	void restructure();
+
+public:
+	SkipListPriorityQueue(int task_num, bool glibc_mem);
+
+	void conclude();
+
+	void insert(int32_t e, int tid);
+	int32_t remove(int tid);
+	KeyVal peek(int tid);
+	bool remove_cond(uint64_t key, int tid);
+};
+
+class SkipListPriorityQueueFactory : public RContainerFactory{
+	SkipListPriorityQueue* build(GlobalTestConfig* gtc){
+		return new SkipListPriorityQueue(gtc->task_num,gtc->environment["glibc"]=="1");
+	}
+};
+
+#endif
@@ -0,0 +1,287 @@
+/*
+
+Copyright 2015 University of Rochester
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+
+
+// Split-ordered lock-free hash map.
+//
+// See:
+//   O. Shalev and N. Shavit. Split-ordered lists: lock-free
+//   extensible hash tables. JACM 2006.
+// 
+
+
+#include <stdlib.h>
+#include "SplitOrderedMap.hpp"
+
+SplitOrderedMap::SplitOrderedMap(int task_num, int duplicatePolicy, bool glibc_mem){
+	this->task_num = task_num;
+	this->duplicatePolicy = duplicatePolicy;
+	bp = new BlockPool<Node>(task_num,glibc_mem);
+	haz = new HazardTracker(task_num, bp, 3, 3);
+	for(int i = 0; i<MAX_SEGMENTS; i++){
+		segments[i].store(NULL);
+	}
+	pending = new padded<int>[task_num];
+	for(int i = 0; i<task_num; i++){
+		pending[i].ui = 0;
+	}
+	size.store(2);
+	count.store(0);
+
+	// bucket 0's sentinel heads the list
+	Node* s = bp->alloc(0);
+	s->init(sentinelKey(0),0,0,NULL);
+	bucketSlot(0)->store(s);
+}
+
+// murmur3 finalizer, less the bit regular keys reserve
+uint32_t SplitOrderedMap::hash(int32_t key){
+	uint32_t h = (uint32_t)key;
+	h ^= h>>16;
+	h *= 0x85ebca6b;
+	h ^= h>>13;
+	h *= 0xc2b2ae35;
+	h ^= h>>16;
+	return h&0x7fffffff;
+}
+
+uint32_t SplitOrderedMap::reverse(uint32_t x){
+	x = ((x>>1)&0x55555555)|((x&0x55555555)<<1);
+	x = ((x>>2)&0x33333333)|((x&0x33333333)<<2);
+	x = ((x>>4)&0x0f0f0f0f)|((x&0x0f0f0f0f)<<4);
+	x = ((x>>8)&0x00ff00ff)|((x&0x00ff00ff)<<8);
+	return (x>>16)|(x<<16);
+}
+
+// MichaelOrderedMap::find from a bucket's sentinel, ordered
+// by split order key and then key
+SplitOrderedMap::findInfo SplitOrderedMap::find(mptr<Node>* start, uint32_t so, int32_t key, int tid){
+	findInfo f;
+	mptr_local<Node> oldptr;
+	mptr_local<Node> newptr;
+	while(true){
+		f.prev = start;
+		f.cur.init(f.prev->all());
+		f.next.init(0);
+
+		haz->reserve(f.cur.ptr(),1,tid); // reserve cur node
+		if(*f.prev!=f.cur){continue;} // snapshot after reserve
+
+		while(true){
+			if(f.cur.ptr()==NULL){f.found=false;return f;}  // reached end of list
+			f.next.init(f.cur.ptr()->next.all()); // read next node's next pointer
+
+			haz->reserve(f.next.ptr(),0,tid); // reserve next
+			if(f.cur->next!=f.next){break;} // snapshot after reserve
+
+			uint32_t cso = f.cur.ptr()->so_key; // copy current keys
+			int32_t ckey = f.cur.ptr()->key;
+			oldptr.init(false,f.cur.ptr(),f.cur.sn()); // get snapshot of prv, cur
+			if(f.prev->all() != oldptr.all()){break;} // verify snapshot of prev, cur
+
+			if(!f.next.marked()){ // check if cur deleted
+				if(cso>so || (cso==so && ckey>=key)){ // check if found key's slot
+					f.found = (cso==so && ckey==key); // check if actually found key
+					return f;
+				}
+				f.prev = &(f.cur.ptr()->next); // iterate prev forward
+				haz->reserve(f.cur.ptr(),2,tid);
+			}
+			else{  // cur is deleted, we should clean
+				oldptr.init(false,f.cur.ptr(),f.cur.sn());
+				newptr.init(false,f.next.ptr(),f.cur.sn()+1);
+				if(f.prev->CAS(oldptr,newptr)){
+					haz->retire(f.cur.ptr(),tid);
+					f.next.init(f.next.marked(),f.next.ptr(),f.cur.sn()+1); // increment sn since we CAS'd
+				}
+				else{break;} // our CAS to remove failed, so try again at current location
+			}
+			f.cur.init(f.next); // iterate cur forward
+			haz->reserve(f.next.ptr(),1,tid);
+		}
+	}
+}
+
+std::atomic<SplitOrderedMap::Node*>* SplitOrderedMap::bucketSlot(uint32_t b){
+	std::atomic<Node*>* seg = segments[b/SEGMENT_SIZE].load();
+	if(seg==NULL){
+		std::atomic<Node*>* fresh = new std::atomic<Node*>[SEGMENT_SIZE];
+		for(int i = 0; i<SEGMENT_SIZE; i++){
+			fresh[i].store(NULL);
+		}
+		if(segments[b/SEGMENT_SIZE].compare_exchange_strong(seg,fresh)){
+			seg = fresh;
+		}
+		else{
+			delete[] fresh; // seg now holds the winner's
+		}
+	}
+	return &seg[b%SEGMENT_SIZE];
+}
+
+SplitOrderedMap::Node* SplitOrderedMap::bucket(uint32_t b, int tid){
+	Node* s = bucketSlot(b)->load();
+	if(s==NULL){
+		initBucket(b,tid);
+		s = bucketSlot(b)->load();
+	}
+	return s;
+}
+
+// links b's sentinel in after its parent's, the bucket
+// it was split from, initializing that first if need be
+void SplitOrderedMap::initBucket(uint32_t b, int tid){
+	uint32_t parent = b^(1u<<(31-__builtin_clz(b)));
+	Node* p = bucket(parent,tid);
+	uint32_t so = sentinelKey(b);
+	Node* s = bp->alloc(tid);
+	findInfo f;
+	mptr_local<Node> oldptr;
+	mptr_local<Node> newptr;
+	while(true){
+		f = find(&(p->next),so,0,tid);
+		if(f.found){
+			// someone else got there first
+			bp->free(s,tid);
+			s = f.cur.ptr();
+			break;
+		}
+		s->init(so,0,0,f.cur.ptr());
+		oldptr.init(false,f.cur.ptr(),f.cur.sn());
+		newptr.init(false,s,f.cur.sn()+1);
+		if(f.prev->CAS(oldptr,newptr)){break;}
+	}
+	haz->clearAll(tid);
+	bucketSlot(b)->store(s);
+}
+
+void SplitOrderedMap::adjustCount(int delta, int tid){
+	int p = pending[tid].ui+delta;
+	if(p<COUNT_BATCH && p>-COUNT_BATCH){
+		pending[tid].ui = p;
+		return;
+	}
+	pending[tid].ui = 0;
+	int64_t c = count.fetch_add(p)+p;
+	uint32_t sz = size.load();
+	if(c>(int64_t)LOAD_FACTOR*sz && sz<(uint32_t)SEGMENT_SIZE*MAX_SEGMENTS){
+		size.compare_exchange_strong(sz,sz*2);
+	}
+}
+
+int32_t SplitOrderedMap::get(int32_t key, int tid){
+	assert(key!=0); // 0 used as EMPTY signal
+	int32_t ret;
+	uint32_t h = hash(key);
+	Node* s = bucket(h&(size.load()-1),tid);
+
+	findInfo f;
+	f = find(&(s->next),regularKey(h),key,tid);
+	if(f.found){
+		ret = f.cur.ptr()->val;
+	}
+	else{
+		ret = EMPTY;
+	}
+	haz->clearAll(tid);
+	return ret;
+}
+
+bool SplitOrderedMap::map(int32_t key, int32_t val, int tid){
+	assert(val!=0); // 0 used as EMPTY signal
+	assert(key!=0); // 0 used as EMPTY signal
+	uint32_t h = hash(key);
+	uint32_t so = regularKey(h);
+	Node* s = bucket(h&(size.load()-1),tid);
+
+	Node* node = bp->alloc(tid);
+	findInfo f;
+	mptr_local<Node> oldptr;
+	mptr_local<Node> newptr;
+	bool inserted = false;
+	bool ret = true;
+
+	while(true){
+		f = find(&(s->next),so,key,tid);
+		if(f.found){
+			if(duplicatePolicy == MichaelOrderedMap::rejectDuplicates){
+				ret = false; break;
+			}
+			else if(duplicatePolicy == MichaelOrderedMap::replaceDuplicates){
+				int32_t oldval = f.cur.ptr()->val;
+				if(f.cur.ptr()->val.compare_exchange_strong(oldval,val,
+				  std::memory_order::memory_order_acq_rel)){
+					break;
+				}
+				else{continue;}
+			}
+			// else appendDuplicates, insert ahead of the others
+		}
+		node->init(so,key,val,f.cur.ptr());
+		oldptr.init(false,f.cur.ptr(),f.cur.sn());
+		newptr.init(false,node,f.cur.sn()+1);
+		if(f.prev->CAS(oldptr,newptr)){inserted = true; break;}
+	}
+	haz->clearAll(tid);
+	if(inserted){
+		adjustCount(1,tid);
+	}
+	else{
+		bp->free(node,tid);
+	}
+	return ret;
+}
+
+int32_t SplitOrderedMap::unmap(int32_t key, int tid){
+	uint32_t h = hash(key);
+	uint32_t so = regularKey(h);
+	Node* s = bucket(h&(size.load()-1),tid);
+
+	mptr_local<Node> oldptr;
+	mptr_local<Node> newptr;
+	findInfo f;
+	int32_t ret;
+
+	while(true){
+		f = find(&(s->next),so,key,tid);
+		if(!f.found){ret = EMPTY; break;} // didn't find key
+
+		// mark as deleted
+		oldptr.init(false,f.next.ptr(),f.next.sn());
+		newptr.init(true,f.next.ptr(),f.next.sn()+1);
+		ret = f.cur.ptr()->val;
+		if(!f.cur->next.CAS(oldptr,newptr)){continue;}
+
+		// remove
+		oldptr.init(false,f.cur.ptr(),f.cur.sn());
+		newptr.init(false,f.next.ptr(),f.cur.sn()+1);
+		if(f.prev->CAS(oldptr,newptr)){
+			haz->retire(f.cur.ptr(),tid);
+		}
+		else{
+			find(&(s->next),so,key,tid); // clean up if necessary
+		}
+		break;
+	}
+	haz->clearAll(tid);
+	if(ret!=EMPTY){
+		adjustCount(-1,tid);
+	}
+	return ret;
+}
@@ -0,0 +1,131 @@
+/*
+
+Copyright 2015 University of Rochester
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+
+
+// Split-ordered lock-free hash map.
+//
+// See:
+//   O. Shalev and N. Shavit. Split-ordered lists: lock-free
+//   extensible hash tables. JACM 2006.
+//
+// One Michael list (the same mptr nodes and hazard pointer find as
+// MichaelOrderedMap) holding every item in split order: the bit
+// reversal of the key's hash.  Each bucket is a sentinel node
+// in the list that starts its stretch, so a lookup walks about
+// LOAD_FACTOR nodes instead of the whole map.  Doubling the table
+// is one CAS on size; nothing moves, and the new buckets insert
+// their sentinels (recursively after their parent bucket's) the
+// first time they are used.  Sentinels are never removed.
+//
+// Keys equal under the 31 bit hash share a split order key and
+// are ordered by key after it.  A key already present is handled
+// as in MichaelOrderedMap, by the duplicate policy given.
+
+
+#ifndef SPLIT_ORDERED_MAP_H
+#define SPLIT_ORDERED_MAP_H
+
+#include <atomic>
+#include "RMap.hpp"
+#include "BlockPool.hpp"
+#include "HazardTracker.hpp"
+#include "MichaelOrderedSet.hpp"
+
+class SplitOrderedMap : public RMap{
+
+	class Node{
+	public:
+		mptr<Node> next;
+		std::atomic<int32_t> val;
+		int32_t key; // 0 in sentinels
+		uint32_t so_key;
+		void init(uint32_t so, int32_t k, int32_t v, Node* d){
+			so_key = so;
+			key = k;
+			val.store(v,std::memory_order::memory_order_release);
+			next.storePtr(d);
+		}
+	};
+
+	class findInfo{
+	public:
+		mptr<Node>* prev;
+		mptr_local<Node> cur;
+		mptr_local<Node> next;
+		bool found;
+		findInfo(){
+			prev = NULL;
+			found = false;
+			cur.init(0);
+			next.init(0);
+		}
+		findInfo(const findInfo& f){
+			prev= f.prev;
+			cur.init(f.cur.all());
+			next.init(f.next.all());
+			found = f.found;
+		}
+	};
+
+	// buckets live in segments allocated on first use
+	static const int SEGMENT_SIZE = 1024;
+	static const int MAX_SEGMENTS = 1024;
+	// mean items per bucket before the table doubles
+	static const int LOAD_FACTOR = 2;
+	// per thread count changes batched before touching count
+	static const int COUNT_BATCH = 32;
+
+	std::atomic<std::atomic<Node*>*> segments[MAX_SEGMENTS];
+	std::atomic<uint32_t> size
+	__attribute__(( aligned(LEVEL1_DCACHE_LINESIZE) ));
+	char pad1[LEVEL1_DCACHE_LINESIZE-sizeof(std::atomic<uint32_t>)];
+	std::atomic<int64_t> count;
+	char pad2[LEVEL1_DCACHE_LINESIZE-sizeof(std::atomic<int64_t>)];
+	padded<int>* pending;
+	int duplicatePolicy;
+	BlockPool<Node>* bp;
+	HazardTracker* haz;
+	int task_num;
+
+	static uint32_t hash(int32_t key);
+	static uint32_t reverse(uint32_t x);
+	static inline uint32_t regularKey(uint32_t h){return reverse(h|0x80000000);}
+	static inline uint32_t sentinelKey(uint32_t b){return reverse(b);}
+
+	findInfo find(mptr<Node>* start, uint32_t so, int32_t key, int tid);
+	std::atomic<Node*>* bucketSlot(uint32_t b);
+	Node* bucket(uint32_t b, int tid);
+	void initBucket(uint32_t b, int tid);
+	void adjustCount(int delta, int tid);
+
+public:
+	SplitOrderedMap(int task_num, int duplicatePolicy, bool glibc_mem);
+
+	int32_t get(int32_t key, int tid);
+	bool map(int32_t key, int32_t val, int tid);
+	int32_t unmap(int32_t key, int tid);
+};
+
+class SplitOrderedMapFactory : public RideableFactory{
+	SplitOrderedMap* build(GlobalTestConfig* gtc){
+		return new SplitOrderedMap(gtc->task_num,MichaelOrderedMap::replaceDuplicates,gtc->environment["glibc"]=="1");
+	}
+};
+
+#endif
@@ -22,8 +22,12 @@ limitations under the License.
 #include "Tests.hpp"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <iostream>
 #include <climits>
+#include <vector>
+#include <algorithm>
+#include <math.h>
 
 using namespace std;
 
@@ -253,7 +257,905 @@ int MarkedPtrTest::execute(GlobalTestConfig* gtc){
 }
 
 
+// RegistryChurnTest methods
+void RegistryChurnTest::init(GlobalTestConfig* gtc){
+	Rideable* ptr = gtc->allocRideable();
+	this->q = dynamic_cast<RContainer*>(ptr);
+	if(!q){
+		errexit("RegistryChurnTest must be run on RContainer type object.");
+	}
+	reg = new ThreadRegistry(gtc->task_num);
+	SlotOwner* o = dynamic_cast<SlotOwner*>(ptr);
+	if(o!=NULL){
+		reg->addOwner(o);
+	}
+	else if(gtc->verbose){
+		cout<<"Rideable keeps no per slot state, running RegistryChurnTest anyway."<<endl;
+	}
+	gtc->recorder->addThreadField("visits",&Recorder::sumInts);
+	gtc->recorder->addThreadField("slots",&Recorder::sumInts);
+}
+
+int RegistryChurnTest::execute(GlobalTestConfig* gtc, LocalTestConfig* ltc){
+	struct timeval time_up = gtc->finish;
+	struct timeval now;
+	gettimeofday(&now,NULL);
+	int ops = 0;
+	int visits = 0;
+	int32_t j;
+
+	while(now.tv_sec < time_up.tv_sec 
+		|| (now.tv_sec==time_up.tv_sec && now.tv_usec<time_up.tv_usec) ){
+		int tid = reg->enter();
+		if(tid==-1){
+			errexit("RegistryChurnTest ran out of slots.");
+		}
+		// every thread inserts before it removes, so a
+		// dual container always has data for its waiters
+		for(int i = 0; i<burst; i++){
+			q->insert(i+1,ThreadRegistry::tid());
+			j=EMPTY;
+			while(j==EMPTY){
+				j=q->remove(ThreadRegistry::tid());
+			}
+			ops+=2;
+		}
+		reg->leave();
+		visits++;
+		gettimeofday(&now,NULL);
+	}
+
+	gtc->recorder->reportThreadInfo("visits",visits,ltc->tid);
+	gtc->recorder->reportThreadInfo("slots",ltc->tid==0?reg->highWater():0,ltc->tid);
+	return ops;
+}
+
+void RegistryChurnTest::cleanup(GlobalTestConfig* gtc){
+	delete reg;
+}
+
+
+// RingChurnTest methods
+void RingChurnTest::init(GlobalTestConfig* gtc){
+	Rideable* ptr = gtc->allocRideable();
+	this->q = dynamic_cast<RContainer*>(ptr);
+	if(!q){
+		errexit("RingChurnTest must be run on RContainer type object.");
+	}
+}
+
+int RingChurnTest::execute(GlobalTestConfig* gtc, LocalTestConfig* ltc){
+	struct timeval time_up = gtc->finish;
+	struct timeval now;
+	gettimeofday(&now,NULL);
+	int ops = 0;
+	int tid = ltc->tid;
+	int32_t j;
+
+	while(now.tv_sec < time_up.tv_sec 
+		|| (now.tv_sec==time_up.tv_sec && now.tv_usec<time_up.tv_usec) ){
+		for(int i = 0; i<burst; i++){
+			q->insert(i+1,tid);
+		}
+		// everyone inserts before removing, so an empty
+		// return is transient
+		for(int i = 0; i<burst; i++){
+			j=EMPTY;
+			while(j==EMPTY){
+				j=q->remove(tid);
+			}
+		}
+		ops+=2*burst;
+		gettimeofday(&now,NULL);
+	}
+	return ops;
+}
+
+
+// SparseActiveTest methods
+void SparseActiveTest::init(GlobalTestConfig* gtc){
+	Rideable* ptr = gtc->allocRideable();
+	this->q = dynamic_cast<RContainer*>(ptr);
+	if(!q){
+		errexit("SparseActiveTest must be run on RContainer type object.");
+	}
+	if(active>gtc->task_num){
+		active = gtc->task_num;
+	}
+}
+
+int SparseActiveTest::execute(GlobalTestConfig* gtc, LocalTestConfig* ltc){
+	struct timeval time_up = gtc->finish;
+	struct timeval now;
+	int ops = 0;
+	int tid = ltc->tid;
+	int32_t j;
+
+	q->insert(tid+1,tid);
+	j=EMPTY;
+	while(j==EMPTY){
+		j=q->remove(tid);
+	}
+	ops+=2;
+
+	gettimeofday(&now,NULL);
+	while(now.tv_sec < time_up.tv_sec 
+		|| (now.tv_sec==time_up.tv_sec && now.tv_usec<time_up.tv_usec) ){
+		if(tid>=active){
+			usleep(1000);
+		}
+		else{
+			q->insert(tid+1,tid);
+			j=EMPTY;
+			while(j==EMPTY){
+				j=q->remove(tid);
+			}
+			ops+=2;
+		}
+		gettimeofday(&now,NULL);
+	}
+	return ops;
+}
+
+
+// ConsumerHeavyTest methods
+void ConsumerHeavyTest::init(GlobalTestConfig* gtc){
+	Rideable* ptr = gtc->allocRideable();
+	this->q = dynamic_cast<RContainer*>(ptr);
+	if(!q){
+		errexit("ConsumerHeavyTest must be run on RContainer type object.");
+	}
+	if(producers>=gtc->task_num){
+		errexit("ConsumerHeavyTest needs more threads than producers.");
+	}
+	consumers_done.store(0);
+}
+
+int ConsumerHeavyTest::execute(GlobalTestConfig* gtc, LocalTestConfig* ltc){
+	struct timeval time_up = gtc->finish;
+	struct timeval now;
+	int ops = 0;
+	int tid = ltc->tid;
+	int consumers = gtc->task_num-producers;
+	int32_t j;
+
+	gettimeofday(&now,NULL);
+	while(now.tv_sec < time_up.tv_sec 
+		|| (now.tv_sec==time_up.tv_sec && now.tv_usec<time_up.tv_usec) ){
+		if(tid<producers){
+			q->insert(tid+1,tid);
+		}
+		else{
+			j=EMPTY;
+			while(j==EMPTY){
+				j=q->remove(tid);
+			}
+		}
+		ops++;
+		gettimeofday(&now,NULL);
+	}
+
+	if(tid<producers){
+		while(consumers_done.load()<consumers){
+			q->insert(tid+1,tid);
+		}
+	}
+	else{
+		consumers_done.fetch_add(1);
+	}
+	return ops;
+}
+
+
+// PingPongTest methods
+void PingPongTest::init(GlobalTestConfig* gtc){
+	ping = dynamic_cast<RContainer*>(gtc->allocRideable());
+	pong = dynamic_cast<RContainer*>(gtc->allocRideable());
+	if(!ping || !pong){
+		errexit("PingPongTest must be run on RContainer type object.");
+	}
+	if(gtc->task_num<2){
+		errexit("PingPongTest needs at least two threads.");
+	}
+	gtc->recorder->addThreadField("rtt_ns",&Recorder::sumInts);
+}
+
+int PingPongTest::execute(GlobalTestConfig* gtc, LocalTestConfig* ltc){
+	struct timeval time_up = gtc->finish;
+	struct timeval now;
+	int ops = 0;
+	int tid = ltc->tid;
+	int32_t j;
+	// tokens count up from 1; -1 tells thread 1 to stop
+	int32_t token = 1;
+	uint64_t start;
+
+	if(tid==0){
+		start = Executor::nowNs();
+		gettimeofday(&now,NULL);
+		while(now.tv_sec < time_up.tv_sec 
+			|| (now.tv_sec==time_up.tv_sec && now.tv_usec<time_up.tv_usec) ){
+			ping->insert(token,tid);
+			j=EMPTY;
+			while(j==EMPTY){
+				j=pong->remove(tid);
+			}
+			assert(j==token);
+			token++;
+			ops++;
+			gettimeofday(&now,NULL);
+		}
+		gtc->recorder->reportThreadInfo("rtt_ns",
+		  ops?(int)((Executor::nowNs()-start)/ops):0,tid);
+		ping->insert(-1,tid);
+	}
+	else if(tid==1){
+		while(true){
+			j=EMPTY;
+			while(j==EMPTY){
+				j=ping->remove(tid);
+			}
+			if(j==-1){break;}
+			pong->insert(j,tid);
+		}
+		gtc->recorder->reportThreadInfo("rtt_ns",0,tid);
+	}
+	else{
+		gtc->recorder->reportThreadInfo("rtt_ns",0,tid);
+	}
+	return ops;
+}
+
+
+// BatchStackTest methods
+void BatchStackTest::init(GlobalTestConfig* gtc){
+	Rideable* ptr = gtc->allocRideable();
+	this->s = dynamic_cast<TreiberStack*>(ptr);
+	if(!s){
+		errexit("BatchStackTest must be run on Treiber Stack.");
+	}
+}
+
+int BatchStackTest::execute(GlobalTestConfig* gtc, LocalTestConfig* ltc){
+	struct timeval time_up = gtc->finish;
+	struct timeval now;
+	int ops = 0;
+	int tid = ltc->tid;
+	int32_t* vals = new int32_t[batch];
+	int got;
+
+	for(int i = 0; i<batch; i++){
+		vals[i] = i+1;
+	}
+	gettimeofday(&now,NULL);
+	while(now.tv_sec < time_up.tv_sec 
+		|| (now.tv_sec==time_up.tv_sec && now.tv_usec<time_up.tv_usec) ){
+		s->push_batch(vals,batch,tid);
+		// others may take some of ours, but what we
+		// pushed keeps the stack from running dry
+		for(got = 0; got<batch;){
+			got+=s->pop_batch(vals,batch-got,tid);
+		}
+		for(int i = 0; i<batch; i++){
+			vals[i] = i+1;
+		}
+		ops+=2*batch;
+		gettimeofday(&now,NULL);
+	}
+	delete[] vals;
+	return ops;
+}
+
+
+// DeepQueueTest methods
+void DeepQueueTest::init(GlobalTestConfig* gtc){
+	Rideable* ptr = gtc->allocRideable();
+	this->q = dynamic_cast<RContainer*>(ptr);
+	if(!q){
+		errexit("DeepQueueTest must be run on RContainer type object.");
+	}
+	for(int i = depth; i>0; i--){
+		q->insert(2*i,0);
+	}
+}
+
+int DeepQueueTest::execute(GlobalTestConfig* gtc, LocalTestConfig* ltc){
+	struct timeval time_up = gtc->finish;
+	struct timeval now;
+	gettimeofday(&now,NULL);
+	int ops = 0;
+	unsigned int r = ltc->seed;
+	int tid = ltc->tid;
+	int32_t j;
+
+	while(now.tv_sec < time_up.tv_sec 
+		|| (now.tv_sec==time_up.tv_sec && now.tv_usec<time_up.tv_usec) ){
+		r = nextRand(r);
+		q->insert(r%(2*depth)+1,tid);
+		// there are always depth items to spare
+		j=EMPTY;
+		while(j==EMPTY){
+			j=q->remove(tid);
+		}
+		ops+=2;
+		gettimeofday(&now,NULL);
+	}
+	return ops;
+}
+
+
+// RankErrorTest methods
+void RankErrorTest::init(GlobalTestConfig* gtc){
+	Rideable* ptr = gtc->allocRideable();
+	this->q = dynamic_cast<RContainer*>(ptr);
+	if(!q){
+		errexit("RankErrorTest must be run on RContainer type object.");
+	}
+	task_num = gtc->task_num;
+	logs = new padded<Event*>[task_num];
+	lens = new padded<int>[task_num];
+	for(int i = 0; i<task_num; i++){
+		logs[i].ui = new Event[LOG_SIZE];
+		lens[i].ui = 0;
+	}
+	clock.store(1);
+	prefill = new int32_t[depth];
+	unsigned int r = 1;
+	for(int i = 0; i<depth; i++){
+		r = nextRand(r);
+		prefill[i] = r%KEY_RANGE+1;
+		q->insert(prefill[i],0);
+	}
+}
+
+int RankErrorTest::execute(GlobalTestConfig* gtc, LocalTestConfig* ltc){
+	struct timeval time_up = gtc->finish;
+	struct timeval now;
+	gettimeofday(&now,NULL);
+	int ops = 0;
+	unsigned int r = ltc->seed;
+	int tid = ltc->tid;
+	Event* log = logs[tid].ui;
+	int len = 0;
+	int32_t j;
+
+	while((now.tv_sec < time_up.tv_sec 
+		|| (now.tv_sec==time_up.tv_sec && now.tv_usec<time_up.tv_usec))
+		&& len+2<=LOG_SIZE ){
+		r = nextRand(r);
+		j = r%KEY_RANGE+1;
+		log[len].stamp = clock.fetch_add(1);
+		log[len].key = j;
+		len++;
+		q->insert(j,tid);
+		j=EMPTY;
+		while(j==EMPTY){
+			j=q->remove(tid);
+		}
+		log[len].stamp = clock.fetch_add(1);
+		log[len].key = -j;
+		len++;
+		ops+=2;
+		gettimeofday(&now,NULL);
+	}
+	lens[tid].ui = len;
+	return ops;
+}
+
+void RankErrorTest::cleanup(GlobalTestConfig* gtc){
+	vector<Event> all;
+	for(int i = 0; i<task_num; i++){
+		all.insert(all.end(),logs[i].ui,logs[i].ui+lens[i].ui);
+		delete[] logs[i].ui;
+	}
+	delete[] logs;
+	delete[] lens;
+	sort(all.begin(),all.end());
+
+	// Fenwick tree of key counts, so a rank is a prefix sum
+	vector<int> tree(KEY_RANGE+1,0);
+	for(int i = 0; i<depth; i++){
+		for(int k = prefill[i]; k<=KEY_RANGE; k+=k&-k){tree[k]++;}
+	}
+	delete[] prefill;
+
+	int64_t sum = 0;
+	int64_t worst = 0;
+	int64_t removes = 0;
+	for(size_t i = 0; i<all.size(); i++){
+		int32_t key = all[i].key;
+		int delta = 1;
+		if(key<0){
+			key = -key;
+			delta = -1;
+			int64_t rank = 0;
+			for(int k = key-1; k>0; k-=k&-k){rank+=tree[k];}
+			sum+=rank;
+			if(rank>worst){worst = rank;}
+			removes++;
+		}
+		for(int k = key; k<=KEY_RANGE; k+=k&-k){tree[k]+=delta;}
+	}
+	cout<<"rank_error mean="<<(removes>0?(double)sum/removes:0)
+	  <<" max="<<worst<<" removes="<<removes<<endl;
+}
 
 
+// BatchRemoveTest methods
+void BatchRemoveTest::init(GlobalTestConfig* gtc){
+	Rideable* ptr = gtc->allocRideable();
+	this->q = dynamic_cast<RPeekableContainer*>(ptr);
+	if(!q){
+		errexit("BatchRemoveTest must be run on RPeekableContainer type object.");
+	}
+	for(int i = depth; i>0; i--){
+		q->insert(2*i,0);
+	}
+}
+
+int BatchRemoveTest::execute(GlobalTestConfig* gtc, LocalTestConfig* ltc){
+	struct timeval time_up = gtc->finish;
+	struct timeval now;
+	gettimeofday(&now,NULL);
+	int ops = 0;
+	unsigned int r = ltc->seed;
+	int tid = ltc->tid;
+	int32_t* vals = new int32_t[k];
+	int n;
 
+	while(now.tv_sec < time_up.tv_sec 
+		|| (now.tv_sec==time_up.tv_sec && now.tv_usec<time_up.tv_usec) ){
+		for(int i = 0; i<k; i++){
+			r = nextRand(r);
+			q->insert(r%(2*depth)+1,tid);
+		}
+		// there are always depth items to spare
+		n = 0;
+		while(n<k){
+			n+=q->remove_batch(k-n,vals,tid);
+		}
+		ops+=2*k;
+		gettimeofday(&now,NULL);
+	}
+	delete[] vals;
+	return ops;
+}
+
+
+// PayloadTest methods
+void PayloadTest::init(GlobalTestConfig* gtc){
+	Rideable* ptr = gtc->allocRideable();
+	this->q = dynamic_cast<RContainer*>(ptr);
+	if(!q){
+		errexit("PayloadTest must be run on RContainer type object.");
+	}
+	wq = NULL;
+	if(wide){
+		wq = new SlotContainer<uint64_t>(q,gtc->task_num,depth+(1<<16));
+	}
+	unsigned int r = 1;
+	for(int i = 0; i<depth; i++){
+		r = nextRand(r);
+		if(wide){
+			wq->insert((uint64_t)r<<32 | (uint32_t)~r,0);
+		}
+		else{
+			q->insert((r&0x3fffffff)+1,0);
+		}
+	}
+}
+
+int PayloadTest::execute(GlobalTestConfig* gtc, LocalTestConfig* ltc){
+	struct timeval time_up = gtc->finish;
+	struct timeval now;
+	gettimeofday(&now,NULL);
+	int ops = 0;
+	unsigned int r = ltc->seed;
+	int tid = ltc->tid;
+	uint64_t w;
+
+	while(now.tv_sec < time_up.tv_sec 
+		|| (now.tv_sec==time_up.tv_sec && now.tv_usec<time_up.tv_usec) ){
+		r = nextRand(r);
+		// there are always depth items to spare
+		if(wide){
+			wq->insert((uint64_t)r<<32 | (uint32_t)~r,tid);
+			while(!wq->remove(&w,tid)){}
+			if((uint32_t)(w>>32)!=~(uint32_t)w){
+				errexit("PayloadTest removed a corrupted 64 bit value.");
+			}
+		}
+		else{
+			q->insert((r&0x3fffffff)+1,tid);
+			while(q->remove(tid)==EMPTY){}
+		}
+		ops+=2;
+		gettimeofday(&now,NULL);
+	}
+	return ops;
+}
+
+
+// MessageTest methods
+void MessageTest::init(GlobalTestConfig* gtc){
+	Rideable* ptr = gtc->allocRideable();
+	this->q = dynamic_cast<RContainer*>(ptr);
+	if(!q){
+		errexit("MessageTest must be run on RContainer type object.");
+	}
+	if((block&(block-1))!=0 || block<(1<<MSG_MIN_CLASS) || block>(1<<MSG_MAX_CLASS)){
+		errexit("MessageTest block size out of range.");
+	}
+	size = block-MessageArena::HEADER;
+	// a thread's blocks are those it made still in the queue,
+	// at most DEPTH plus one per thread, and those released by
+	// other threads not yet taken back, at most one per thread
+	arena = new MessageArena(gtc->task_num,(size_t)block*(DEPTH+2*gtc->task_num));
+	bufs = new padded<char*>[gtc->task_num];
+	for(int i = 0; i<gtc->task_num; i++){
+		bufs[i].ui = (char*)malloc(size);
+		memset(bufs[i].ui,0,size);
+	}
+	for(int i = 0; i<DEPTH; i++){
+		int32_t h = arena->alloc(size,0);
+		memset(arena->data(h),i,size);
+		*(int32_t*)arena->data(h) = i;
+		q->insert(h,0);
+	}
+}
+
+int MessageTest::execute(GlobalTestConfig* gtc, LocalTestConfig* ltc){
+	struct timeval time_up = gtc->finish;
+	struct timeval now;
+	gettimeofday(&now,NULL);
+	int ops = 0;
+	int tid = ltc->tid;
+	char* buf = bufs[tid].ui;
+	int32_t h;
+	char* m;
+	unsigned char tag = tid;
+
+	while(now.tv_sec < time_up.tv_sec 
+		|| (now.tv_sec==time_up.tv_sec && now.tv_usec<time_up.tv_usec) ){
+		h = arena->alloc(size,tid);
+		m = (char*)arena->data(h);
+		if(copy){
+			memset(buf,tag,size);
+			*(int32_t*)buf = tag;
+			memcpy(m,buf,size);
+		}
+		else{
+			memset(m,tag,size);
+			*(int32_t*)m = tag;
+		}
+		q->insert(h,tid);
+		tag++;
+
+		// there are always DEPTH messages to spare
+		h = EMPTY;
+		while(h==EMPTY){
+			h = q->remove(tid);
+		}
+		m = (char*)arena->data(h);
+		if(copy){
+			memcpy(buf,m,size);
+			m = buf;
+		}
+		// first word says what the last byte should be
+		if((unsigned char)m[size-1]!=(unsigned char)*(int32_t*)m){
+			errexit("MessageTest read a torn message.");
+		}
+		arena->release(h,tid);
+		ops+=2;
+		gettimeofday(&now,NULL);
+	}
+	return ops;
+}
+
+void MessageTest::cleanup(GlobalTestConfig* gtc){
+	int64_t remote = 0;
+	for(int i = 0; i<gtc->task_num; i++){
+		remote+=arena->remoteFrees(i);
+	}
+	cout<<"remote_releases="<<remote<<endl;
+	for(int i = 0; i<gtc->task_num; i++){
+		free(bufs[i].ui);
+	}
+	delete[] bufs;
+	delete arena;
+}
+
+
+// MapMixTest methods
+void MapMixTest::init(GlobalTestConfig* gtc){
+	Rideable* ptr = gtc->allocRideable();
+	this->m = dynamic_cast<RMap*>(ptr);
+	if(!m){
+		errexit("MapMixTest must be run on RMap type object.");
+	}
+	// descending, so a sorted list prefills at its head
+	for(int i = range-1; i>0; i-=2){
+		m->map(i,i,0);
+	}
+}
+
+int MapMixTest::execute(GlobalTestConfig* gtc, LocalTestConfig* ltc){
+	struct timeval time_up = gtc->finish;
+	struct timeval now;
+	gettimeofday(&now,NULL);
+	int ops = 0;
+	unsigned int r = ltc->seed;
+	int tid = ltc->tid;
+	int32_t key;
+	int op;
 
+	while(now.tv_sec < time_up.tv_sec 
+		|| (now.tv_sec==time_up.tv_sec && now.tv_usec<time_up.tv_usec) ){
+		r = nextRand(r);
+		key = (r>>8)%range+1;
+		r = nextRand(r);
+		op = (r>>8)%200;
+		if(op<2*lookup){
+			m->get(key,tid);
+		}
+		else if(op&1){
+			m->map(key,key,tid);
+		}
+		else{
+			m->unmap(key,tid);
+		}
+		ops++;
+		gettimeofday(&now,NULL);
+	}
+	return ops;
+}
+
+
+// KeyedRendezvousTest methods
+void KeyedRendezvousTest::init(GlobalTestConfig* gtc){
+	Rideable* ptr = gtc->allocRideable();
+	this->q = dynamic_cast<RKeyedDualContainer*>(ptr);
+	if(!q){
+		errexit("KeyedRendezvousTest must be run on RKeyedDualContainer type object.");
+	}
+	cdf = new double[keys];
+	double sum = 0;
+	for(int i = 0; i<keys; i++){
+		sum+=1.0/pow(i+1,skew);
+		cdf[i] = sum;
+	}
+	for(int i = 0; i<keys; i++){
+		cdf[i]/=sum;
+	}
+	pairs = new padded<PairState>[gtc->task_num/2+1];
+	for(int i = 0; i<gtc->task_num/2+1; i++){
+		pairs[i].ui.removed.store(0);
+		pairs[i].ui.done.store(false);
+	}
+	removers_done.store(0);
+}
+
+// rank of the key by popularity, from 1
+int32_t KeyedRendezvousTest::pickKey(unsigned int& r){
+	r = nextRand(r);
+	double u = (r>>8)/(double)(1<<24);
+	return (lower_bound(cdf,cdf+keys,u)-cdf)+1;
+}
+
+int KeyedRendezvousTest::execute(GlobalTestConfig* gtc, LocalTestConfig* ltc){
+	struct timeval time_up = gtc->finish;
+	struct timeval now;
+	gettimeofday(&now,NULL);
+	int ops = 0;
+	int tid = ltc->tid;
+	PairState* pair = &(pairs[tid/2].ui);
+	unsigned int r = tid/2+1; // same sequence for both of the pair
+	int removers = gtc->task_num-gtc->task_num/2; // odd tids, and any odd thread out
+	int64_t inserted = 0;
+	int32_t k;
+
+	if(tid%2==0 && tid==gtc->task_num-1){
+		// no partner
+		r = ltc->seed;
+		while(now.tv_sec < time_up.tv_sec 
+			|| (now.tv_sec==time_up.tv_sec && now.tv_usec<time_up.tv_usec) ){
+			k = pickKey(r);
+			q->insert(k,tid+1,tid);
+			q->remove(k,tid);
+			ops+=2;
+			gettimeofday(&now,NULL);
+		}
+		removers_done.fetch_add(1);
+	}
+	else if(tid%2==0){
+		// inserter, runs until every remover is done, since
+		// another pair's remover may be waiting on our keys
+		while(removers_done.load()<removers){
+			if(!pair->done.load() && inserted-pair->removed.load()>=WINDOW){
+				continue;
+			}
+			k = pickKey(r);
+			q->insert(k,tid+1,tid);
+			inserted++;
+			ops++;
+		}
+	}
+	else{
+		while(now.tv_sec < time_up.tv_sec 
+			|| (now.tv_sec==time_up.tv_sec && now.tv_usec<time_up.tv_usec) ){
+			k = pickKey(r);
+			q->remove(k,tid);
+			pair->removed.fetch_add(1);
+			ops++;
+			gettimeofday(&now,NULL);
+		}
+		pair->done.store(true);
+		removers_done.fetch_add(1);
+	}
+	return ops;
+}
+
+void KeyedRendezvousTest::cleanup(GlobalTestConfig* gtc){
+	delete[] cdf;
+	delete[] pairs;
+}
+
+
+// OpLatencyTest methods
+void OpLatencyTest::init(GlobalTestConfig* gtc){
+	Rideable* ptr = gtc->allocRideable();
+	this->q = dynamic_cast<RContainer*>(ptr);
+	if(!q){
+		errexit("OpLatencyTest must be run on RContainer type object.");
+	}
+	gtc->recorder->addThreadField("max_op_us",&Recorder::concat);
+	gtc->recorder->addThreadField("mean_op_ns",&Recorder::concat);
+}
+
+int OpLatencyTest::execute(GlobalTestConfig* gtc, LocalTestConfig* ltc){
+	struct timeval time_up = gtc->finish;
+	struct timeval now;
+	int ops = 0;
+	int tid = ltc->tid;
+	int32_t j;
+	uint64_t t0, t1, max_ns = 0, total_ns = 0;
+
+	gettimeofday(&now,NULL);
+	while(now.tv_sec < time_up.tv_sec 
+		|| (now.tv_sec==time_up.tv_sec && now.tv_usec<time_up.tv_usec) ){
+		t0 = Executor::nowNs();
+		q->insert(tid+1,tid);
+		t1 = Executor::nowNs();
+		max_ns = std::max(max_ns,t1-t0);
+		total_ns+=t1-t0;
+		j=EMPTY;
+		while(j==EMPTY){
+			j=q->remove(tid);
+		}
+		t0 = Executor::nowNs();
+		max_ns = std::max(max_ns,t0-t1);
+		total_ns+=t0-t1;
+		ops+=2;
+		gettimeofday(&now,NULL);
+	}
+	gtc->recorder->reportThreadInfo("max_op_us",(int)(max_ns/1000),ltc->tid);
+	gtc->recorder->reportThreadInfo("mean_op_ns",ops?(int)(total_ns/ops):0,ltc->tid);
+	return ops;
+}
+
+
+// ExecutorTest methods
+void ExecutorTest::init(GlobalTestConfig* gtc){
+	Rideable* ptr = gtc->allocRideable();
+	RContainer* q = dynamic_cast<RContainer*>(ptr);
+	if(!q){
+		errexit("Executor tests must be run on RContainer type object.");
+	}
+	ex = new Executor(q,gtc->task_num,gtc->environment["glibc"]=="1");
+	finish = gtc->finish;
+	gtc->recorder->addThreadField("steals",&Recorder::sumInts);
+	gtc->recorder->addThreadField("wakes",&Recorder::sumInts);
+}
+
+// forks one round at a time, stopping the executor when time is up
+void ExecutorTest::driver(Executor* ex, Task* t, int tid){
+	ExecutorTest* test = (ExecutorTest*)t->ctx;
+	struct timeval now;
+	if(t->in>0){
+		test->verify(t);
+	}
+	gettimeofday(&now,NULL);
+	if(now.tv_sec > test->finish.tv_sec 
+		|| (now.tv_sec==test->finish.tv_sec && now.tv_usec>=test->finish.tv_usec) ){
+		ex->stop(tid);
+		return;
+	}
+	t->in++;
+	t->out = 0;
+	test->round(t,tid);
+}
+
+int ExecutorTest::execute(GlobalTestConfig* gtc, LocalTestConfig* ltc){
+	int tid = ltc->tid;
+	if(tid==0){
+		Task* d = ex->newTask(&ExecutorTest::driver,NULL,tid);
+		d->ctx = this;
+		ex->spawn(d,tid);
+	}
+	ex->run(tid);
+	gtc->recorder->reportThreadInfo("steals",(int)ex->steals(tid),tid);
+	gtc->recorder->reportThreadInfo("wakes",(int)ex->wakes(tid),tid);
+	return (int)ex->tasksRun(tid);
+}
+
+void ExecutorTest::cleanup(GlobalTestConfig* gtc){
+	int64_t wakes = 0;
+	int64_t ns = 0;
+	for(int i = 0; i<gtc->task_num; i++){
+		wakes+=ex->wakes(i);
+		ns+=ex->wakeNs(i);
+	}
+	if(wakes>0){
+		cout<<"wake latency (mean ns)="<<ns/wakes<<endl;
+	}
+	delete ex;
+}
+
+
+// ForkJoinTest methods
+ForkJoinTest::ForkJoinTest(int n){
+	this->n = n;
+	int64_t a = 0, b = 1;
+	for(int i = 0; i<n; i++){
+		int64_t c = a+b;
+		a = b;
+		b = c;
+	}
+	expected = a;
+}
+
+void ForkJoinTest::round(Task* driver, int tid){
+	ex->continueWith(driver,&ExecutorTest::driver,1);
+	Task* root = ex->newTask(&ForkJoinTest::fib,driver,tid);
+	root->in = n;
+	ex->spawn(root,tid);
+}
+
+void ForkJoinTest::verify(Task* driver){
+	if(driver->out!=expected){
+		errexit("ForkJoinTest computed the wrong result.");
+	}
+}
+
+void ForkJoinTest::fib(Executor* ex, Task* t, int tid){
+	if(t->in<2){
+		__sync_fetch_and_add(&t->parent->out,t->in);
+		return;
+	}
+	ex->continueWith(t,&ForkJoinTest::fibJoin,2);
+	Task* a = ex->newTask(&ForkJoinTest::fib,t,tid);
+	a->in = t->in-1;
+	Task* b = ex->newTask(&ForkJoinTest::fib,t,tid);
+	b->in = t->in-2;
+	ex->spawn(a,tid);
+	ex->spawn(b,tid);
+}
+
+void ForkJoinTest::fibJoin(Executor* ex, Task* t, int tid){
+	__sync_fetch_and_add(&t->parent->out,t->out);
+}
+
+
+// FanOutTest methods
+void FanOutTest::round(Task* driver, int tid){
+	ex->continueWith(driver,&ExecutorTest::driver,width);
+	for(int i = 0; i<width; i++){
+		Task* l = ex->newTask(&FanOutTest::leaf,driver,tid);
+		l->in = i;
+		ex->spawn(l,tid);
+	}
+}
+
+void FanOutTest::leaf(Executor* ex, Task* t, int tid){
+	__sync_fetch_and_add(&t->parent->out,1);
+}
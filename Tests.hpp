@@ -28,6 +28,12 @@ limitations under the License.
 #include "Harness.hpp"
 #include "RDualContainer.hpp"
 #include "MichaelOrderedSet.hpp"
+#include "ThreadRegistry.hpp"
+#include "Executor.hpp"
+#include "TreiberStack.hpp"
+#include "KeyedDual.hpp"
+#include "TypedContainer.hpp"
+#include "MessageArena.hpp"
 
 class PotatoTest : public Test{
 
@@ -55,6 +61,297 @@ public:
 	void cleanup(GlobalTestConfig* gtc){}
 };
 
+// Threads repeatedly enter the registry, do a short burst
+// of insert/remove pairs under whatever tid they were given,
+// and leave again, so every slot passes between threads.
+class RegistryChurnTest : public Test{
+	ThreadRegistry* reg;
+	int burst;
+public:
+	RegistryChurnTest(int burst){this->burst = burst;}
+	RegistryChurnTest(){burst = 100;}
+	RContainer* q;
+	void init(GlobalTestConfig* gtc);
+	int execute(GlobalTestConfig* gtc, LocalTestConfig* ltc);
+	void cleanup(GlobalTestConfig* gtc);
+};
+
+// Each thread inserts a burst larger than a ring, then removes
+// as many, so the ring queues keep retiring rings.  Run with
+// -dreclaim=headindex|ebr|ibr (and -dreclaim_batch=N) to compare
+// reclamation overhead; the rideable reports its peak backlog
+// of retired rings at conclude().
+class RingChurnTest : public Test{
+	int burst;
+public:
+	RingChurnTest(int burst){this->burst = burst;}
+	RingChurnTest(){burst = 4096;}
+	RContainer* q;
+	void init(GlobalTestConfig* gtc);
+	int execute(GlobalTestConfig* gtc, LocalTestConfig* ltc);
+	void cleanup(GlobalTestConfig* gtc){}
+};
+
+// Every thread does one insert/remove pair, so it has touched
+// its slot, but afterwards only the first few keep working and
+// the rest sleep until time is up.  Shows whether per operation
+// cost follows the active threads or the thread count.
+class SparseActiveTest : public Test{
+	int active;
+public:
+	SparseActiveTest(int active){this->active = active;}
+	SparseActiveTest(){active = 2;}
+	RContainer* q;
+	void init(GlobalTestConfig* gtc);
+	int execute(GlobalTestConfig* gtc, LocalTestConfig* ltc);
+	void cleanup(GlobalTestConfig* gtc){}
+};
+
+// A few producers insert as fast as they can and every other
+// thread removes, so most removes find data or wait briefly.
+// Once time is up the producers keep inserting until every
+// consumer has left, so a waiting remove always returns.
+class ConsumerHeavyTest : public Test{
+	int producers;
+	std::atomic<int> consumers_done;
+public:
+	ConsumerHeavyTest(int producers){this->producers = producers;}
+	ConsumerHeavyTest(){producers = 1;}
+	RContainer* q;
+	void init(GlobalTestConfig* gtc);
+	int execute(GlobalTestConfig* gtc, LocalTestConfig* ltc);
+	void cleanup(GlobalTestConfig* gtc){}
+};
+
+// Threads 0 and 1 bounce a token through two instances of the
+// rideable, one per direction; every other thread sits out.
+// Ops are round trips, and thread 0 reports their mean time.
+class PingPongTest : public Test{
+public:
+	RContainer* ping;
+	RContainer* pong;
+	void init(GlobalTestConfig* gtc);
+	int execute(GlobalTestConfig* gtc, LocalTestConfig* ltc);
+	void cleanup(GlobalTestConfig* gtc){}
+};
+
+// Each thread pushes a batch of k with TreiberStack::push_batch,
+// then pops k back with pop_batch.  Ops are elements, so runs
+// with different k compare throughput per element.
+class BatchStackTest : public Test{
+	int batch;
+public:
+	BatchStackTest(int batch){this->batch = batch;}
+	BatchStackTest(){batch = 8;}
+	TreiberStack* s;
+	void init(GlobalTestConfig* gtc);
+	int execute(GlobalTestConfig* gtc, LocalTestConfig* ltc);
+	void cleanup(GlobalTestConfig* gtc){}
+};
+
+// Prefills the container with depth items, then every thread
+// does insert/remove pairs on random keys, so the depth holds
+// steady.  For comparing priority queues as they grow; the
+// prefill is in descending order, which a sorted list takes
+// at its head.
+class DeepQueueTest : public Test{
+	int depth;
+public:
+	DeepQueueTest(int depth){this->depth = depth;}
+	DeepQueueTest(){depth = 1000;}
+	RContainer* q;
+	void init(GlobalTestConfig* gtc);
+	int execute(GlobalTestConfig* gtc, LocalTestConfig* ltc);
+	void cleanup(GlobalTestConfig* gtc){}
+};
+
+// DeepQueueTest's workload with every operation stamped from a
+// shared counter, inserts before the call and removes after it.
+// cleanup() replays the logs in stamp order and prints the mean
+// and worst rank of each removed key among the keys present,
+// which is 0 for an exact priority queue give or take the ops in
+// flight.  A thread stops once its log is full.
+class RankErrorTest : public Test{
+	struct Event{
+		uint64_t stamp;
+		int32_t key; // negated for removes
+		bool operator<(const Event& e) const{return stamp<e.stamp;}
+	};
+	static const int KEY_RANGE = 1<<20;
+	static const int LOG_SIZE = 1<<18;
+	int depth;
+	int32_t* prefill;
+	std::atomic<uint64_t> clock;
+	padded<Event*>* logs;
+	padded<int>* lens;
+	int task_num;
+public:
+	RankErrorTest(int depth){this->depth = depth;}
+	RankErrorTest(){depth = 1000;}
+	RContainer* q;
+	void init(GlobalTestConfig* gtc);
+	int execute(GlobalTestConfig* gtc, LocalTestConfig* ltc);
+	void cleanup(GlobalTestConfig* gtc);
+};
+
+// DeepQueueTest's workload in batches: k inserts, then k
+// removes through remove_batch, so containers overriding it
+// can be compared per element as k grows.  Counts elements.
+class BatchRemoveTest : public Test{
+	int depth;
+	int k;
+public:
+	BatchRemoveTest(int k, int depth){this->k = k; this->depth = depth;}
+	BatchRemoveTest(int k){this->k = k; depth = 1000;}
+	BatchRemoveTest(){k = 16; depth = 1000;}
+	RPeekableContainer* q;
+	void init(GlobalTestConfig* gtc);
+	int execute(GlobalTestConfig* gtc, LocalTestConfig* ltc);
+	void cleanup(GlobalTestConfig* gtc){}
+};
+
+// DeepQueueTest's workload with 64 bit values carried through
+// the container by a SlotContainer when wide, beside the plain
+// int32_t run, to price the slot indirection.  Each wide value
+// carries a check of itself, verified on removal.  Priority
+// queues would order the wide run by slot number.
+class PayloadTest : public Test{
+	bool wide;
+	int depth;
+public:
+	PayloadTest(bool wide){this->wide = wide; depth = 1000;}
+	PayloadTest(){wide = false; depth = 1000;}
+	RContainer* q;
+	SlotContainer<uint64_t>* wq;
+	void init(GlobalTestConfig* gtc);
+	int execute(GlobalTestConfig* gtc, LocalTestConfig* ltc);
+	void cleanup(GlobalTestConfig* gtc){delete wq;}
+};
+
+// Insert/remove pairs of messages passed as MessageArena
+// handles.  Each message fills one arena block of block bytes,
+// less the header, so a power of two block size is not rounded
+// up to the next class.  The producer fills the block in place,
+// the consumer checks it in place and releases it, usually to
+// another thread's slab.  With copy, each side also copies the
+// message through a private buffer, as with side buffers.
+// Counts messages.
+class MessageTest : public Test{
+	static const int DEPTH = 16;
+	int block;
+	int size; // message bytes, block less the header
+	bool copy;
+	MessageArena* arena;
+	padded<char*>* bufs;
+public:
+	MessageTest(int block, bool copy){this->block = block; this->copy = copy;}
+	MessageTest(int block){this->block = block; copy = false;}
+	MessageTest(){block = 64; copy = false;}
+	RContainer* q;
+	void init(GlobalTestConfig* gtc);
+	int execute(GlobalTestConfig* gtc, LocalTestConfig* ltc);
+	void cleanup(GlobalTestConfig* gtc);
+};
+
+// Random get, map and unmap on a map prefilled with half of
+// range keys; lookup percent of the ops are gets and the rest
+// split evenly between map and unmap, so the size holds steady.
+class MapMixTest : public Test{
+	int lookup;
+	int range;
+public:
+	MapMixTest(int lookup, int range){this->lookup = lookup; this->range = range;}
+	MapMixTest(int lookup){this->lookup = lookup; range = 1<<16;}
+	MapMixTest(){lookup = 90; range = 1<<16;}
+	RMap* m;
+	void init(GlobalTestConfig* gtc);
+	int execute(GlobalTestConfig* gtc, LocalTestConfig* ltc);
+	void cleanup(GlobalTestConfig* gtc){}
+};
+
+// Threads work in pairs that draw the same sequence of keys from
+// a Zipf distribution over keys distinct keys (skew 0 is uniform):
+// one inserts each key, the other removes it, so removes usually
+// wait for their insert.  The inserter stays at most WINDOW keys
+// ahead, and a remove may take another pair's insert of the same
+// key, which the other inserters make up: they keep going,
+// past the window once their own remover is done, until every
+// remover has finished.  An odd thread out does insert/remove
+// pairs on its own.
+class KeyedRendezvousTest : public Test{
+	struct PairState{
+		std::atomic<int64_t> removed;
+		std::atomic<bool> done;
+	};
+	static const int WINDOW = 64;
+	std::atomic<int> removers_done;
+	int keys;
+	double skew;
+	double* cdf;
+	padded<PairState>* pairs;
+	int32_t pickKey(unsigned int& r);
+public:
+	KeyedRendezvousTest(int keys, double skew){this->keys = keys; this->skew = skew;}
+	KeyedRendezvousTest(){keys = 100000; skew = 0.99;}
+	RKeyedDualContainer* q;
+	void init(GlobalTestConfig* gtc);
+	int execute(GlobalTestConfig* gtc, LocalTestConfig* ltc);
+	void cleanup(GlobalTestConfig* gtc);
+};
+
+// Insert/remove pairs like RingChurnTest with a burst of one,
+// timing every operation.  Reports each thread's worst case
+// latency, to set beside throughput when tuning combining.
+class OpLatencyTest : public Test{
+public:
+	RContainer* q;
+	void init(GlobalTestConfig* gtc);
+	int execute(GlobalTestConfig* gtc, LocalTestConfig* ltc);
+	void cleanup(GlobalTestConfig* gtc){}
+};
+
+// Runs an Executor whose ready queue is the rideable, with every
+// test thread as a worker.  Subclasses supply the round task,
+// which is forked by a driver task until time is up; ops are the
+// tasks each worker ran.
+class ExecutorTest : public Test{
+protected:
+	Executor* ex;
+	static void driver(Executor* ex, Task* t, int tid);
+	virtual void round(Task* driver, int tid)=0;
+	virtual void verify(Task* driver){}
+public:
+	struct timeval finish;
+	void init(GlobalTestConfig* gtc);
+	int execute(GlobalTestConfig* gtc, LocalTestConfig* ltc);
+	void cleanup(GlobalTestConfig* gtc);
+};
+
+// each round computes fib(n) by naive fork/join
+class ForkJoinTest : public ExecutorTest{
+	int n;
+	int64_t expected;
+	static void fib(Executor* ex, Task* t, int tid);
+	static void fibJoin(Executor* ex, Task* t, int tid);
+	void round(Task* driver, int tid);
+	void verify(Task* driver);
+public:
+	ForkJoinTest(int n);
+	ForkJoinTest() : ForkJoinTest(20){}
+};
+
+// each round spawns width tiny tasks at once, after the workers
+// have gone idle, so most reach a waiting worker through the
+// ready queue; reports the mean spawn to start latency of those
+class FanOutTest : public ExecutorTest{
+	int width;
+	static void leaf(Executor* ex, Task* t, int tid);
+	void round(Task* driver, int tid);
+public:
+	FanOutTest(int width){this->width = width;}
+	FanOutTest(){width = 64;}
+};
+
 
 
 
@@ -0,0 +1,73 @@
+/*
+
+Copyright 2015 University of Rochester
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+
+
+#include "ThreadRegistry.hpp"
+#include <assert.h>
+
+__thread int ThreadRegistry::my_tid = -1;
+
+ThreadRegistry::ThreadRegistry(int capacity){
+	this->capacity = capacity;
+	taken = new padded<std::atomic<bool>>[capacity];
+	for(int i = 0; i<capacity; i++){
+		taken[i].ui.store(false);
+	}
+	high.store(0);
+	pthread_mutex_init(&owners_lock,NULL);
+}
+
+ThreadRegistry::~ThreadRegistry(){
+	delete[] taken;
+	pthread_mutex_destroy(&owners_lock);
+}
+
+int ThreadRegistry::enter(){
+	if(my_tid!=-1){return my_tid;}
+	// lowest free slot keeps the tids dense
+	for(int i = 0; i<capacity; i++){
+		bool f = false;
+		if(!taken[i].ui.load(std::memory_order_relaxed) &&
+		  taken[i].ui.compare_exchange_strong(f,true,std::memory_order_acq_rel)){
+			int h = high.load();
+			while(h<i+1 && !high.compare_exchange_weak(h,i+1)){}
+			my_tid = i;
+			return i;
+		}
+	}
+	return -1;
+}
+
+void ThreadRegistry::leave(){
+	int tid = my_tid;
+	if(tid==-1){return;}
+	pthread_mutex_lock(&owners_lock);
+	for(size_t i = 0; i<owners.size(); i++){
+		owners[i]->releaseSlot(tid);
+	}
+	pthread_mutex_unlock(&owners_lock);
+	my_tid = -1;
+	taken[tid].ui.store(false,std::memory_order_release);
+}
+
+void ThreadRegistry::addOwner(SlotOwner* o){
+	pthread_mutex_lock(&owners_lock);
+	owners.push_back(o);
+	pthread_mutex_unlock(&owners_lock);
+}
@@ -0,0 +1,82 @@
+/*
+
+Copyright 2015 University of Rochester
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+
+
+#ifndef THREAD_REGISTRY_HPP
+#define THREAD_REGISTRY_HPP
+
+#ifndef _REENTRANT
+#define _REENTRANT		/* basic 3-lines for threads */
+#endif
+
+#include <atomic>
+#include <vector>
+#include <pthread.h>
+#include "ConcurrentPrimitives.hpp"
+
+// Every container sizes its per thread state (hazards,
+// retired lists, waiters, request slots, block subpools)
+// by task_num and expects a dense tid in [0,task_num).
+// The registry lets a changing population of threads share
+// those slots: a thread enter()s to get the lowest free tid,
+// which it then finds with the thread local tid() at no cost
+// per operation, and leave()s when done with the containers.
+//
+// A slot is reissued only after every SlotOwner has released
+// it, so its hazards are clear.  Anything still on the slot's
+// retired lists (or free in its subpool) is inherited by the
+// next owner, which is safe since those lists are only ever
+// touched by the slot's current owner.
+//
+// The thread local tid is shared, so use one registry per process.
+
+class SlotOwner{
+public:
+	// called on behalf of a thread leaving the registry, after its
+	// last operation and before its tid can be handed out again
+	virtual void releaseSlot(int tid)=0;
+	virtual ~SlotOwner(){}
+};
+
+class ThreadRegistry{
+	int capacity;
+	padded<std::atomic<bool>>* taken;
+	std::atomic<int> high; // one past the highest tid ever issued
+	std::vector<SlotOwner*> owners;
+	pthread_mutex_t owners_lock;
+
+	static __thread int my_tid;
+
+public:
+	ThreadRegistry(int capacity);
+	~ThreadRegistry();
+
+	// returns the caller's tid, or -1 if all slots are taken
+	int enter();
+	void leave();
+	static inline int tid(){return my_tid;}
+
+	// tids issued so far lie in [0,highWater())
+	int highWater(){return high.load(std::memory_order_acquire);}
+	int getCapacity(){return capacity;}
+
+	void addOwner(SlotOwner* o);
+};
+
+#endif
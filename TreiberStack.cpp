@@ -54,12 +54,27 @@ TreiberStack::TreiberStack(int task_num, bool glibc_mem){
 		}
 	}
 
+	counts = new padded<OpCounts>[task_num];
+	for(int i=0;i<task_num;i++){
+		counts[i].ui.pushes = 0;
+		counts[i].ui.pops = 0;
+	}
+	#ifdef TSTACK_SIZE_TRACKING
 	this->maxSize = 0;
+	#endif
 }
 
 void TreiberStack::conclude(){
 	//dummy = top.ptr();
+	#ifdef TSTACK_SIZE_TRACKING
 	cout<<"maxSize="<<maxSize<<endl;
+	#endif
+	int64_t pushes = 0, pops = 0;
+	for(int i=0;i<task_num;i++){
+		pushes+=counts[i].ui.pushes;
+		pops+=counts[i].ui.pops;
+	}
+	cout<<"pushes="<<pushes<<" pops="<<pops<<" size="<<pushes-pops<<endl;
 	cout<<"dummy="<<dummy<<endl;
 	int i = 0;
 	while(this->remove(0)!=EMPTY){
@@ -72,22 +87,29 @@ void TreiberStack::push(int32_t val,int tid) {
 	cptr_local<Node> topCopy; 
 	newNode = bp->alloc(tid);
 	newNode->init(val,0,NULL);
+	#ifdef TSTACK_SIZE_TRACKING
 	int size=0;
+	#endif
 	while(true) {
 		topCopy.init(top.all()); // read top pointer
 		//newNode->down.storePtr(top.ptr()); // set newNode's down to top
 		newNode->down = top.ptr();
+		#ifdef TSTACK_SIZE_TRACKING
 		if(newNode->down!=NULL){
 			size = newNode->down->size+1;
 			newNode->size = size;
 		}
 		else{size=1;newNode->size = size;}
+		#endif
 		if(top.CAS(topCopy,newNode)){// swing top
+			#ifdef TSTACK_SIZE_TRACKING
 			while(true){
 				int oldSize = maxSize.load();
 				if(oldSize>=size){break;}
 				if(maxSize.compare_exchange_strong(oldSize,size)){break;}
 			}
+			#endif
+			counts[tid].ui.pushes++;
 			return; // finished if succeed
 		} 
 	}
@@ -104,19 +126,94 @@ int32_t TreiberStack::pop(int tid) {
 		} 
 		else {
 			newTop = topCopy->down; // get new top
+			#ifdef TSTACK_SIZE_TRACKING
 			int topSize = topCopy->size;
 			int newSize = 0;
 			if(newTop!=NULL){newSize = newTop->size;}
+			#endif
 			if(top.CAS(topCopy,newTop)){// swing top
+				#ifdef TSTACK_SIZE_TRACKING
 				assert((newTop==NULL && topSize==1)|| (newTop!=NULL && topSize-1==newSize));
+				#endif
 				int32_t val = topCopy->val;
 				bp->free(topCopy.ptr(),tid);
+				counts[tid].ui.pops++;
 				return val; // finished if succeed
 			}
 		}
 	}
 }
 
+void TreiberStack::push_batch(int32_t* vals, int k, int tid){
+	cptr_local<Node> topCopy;
+	if(k<=0){return;}
+
+	// build the chain bottom up; only its bottom's down changes per try
+	Node* bottom = bp->alloc(tid);
+	bottom->init(vals[0],0,NULL);
+	Node* chainTop = bottom;
+	for(int i=1;i<k;i++){
+		Node* n = bp->alloc(tid);
+		n->init(vals[i],0,chainTop);
+		chainTop = n;
+	}
+
+	while(true){
+		topCopy.init(top.all()); // read top pointer
+		bottom->down = topCopy.ptr();
+		#ifdef TSTACK_SIZE_TRACKING
+		int size = bottom->down!=NULL?bottom->down->size:0;
+		Node* n = chainTop;
+		for(int i=k;i>0;i--){
+			n->size = size+i;
+			n = n->down;
+		}
+		#endif
+		if(top.CAS(topCopy,chainTop)){// swing top to the whole chain
+			#ifdef TSTACK_SIZE_TRACKING
+			while(true){
+				int oldSize = maxSize.load();
+				if(oldSize>=size+k){break;}
+				if(maxSize.compare_exchange_strong(oldSize,size+k)){break;}
+			}
+			#endif
+			counts[tid].ui.pushes+=k;
+			return;
+		}
+	}
+}
+
+int TreiberStack::pop_batch(int32_t* out, int k, int tid){
+	cptr_local<Node> topCopy;
+	Node* newTop;
+	int n;
+
+	while(true){
+		topCopy.init(top.all()); // read top pointer
+		if (topCopy.ptr()==NULL) { // check if empty
+			return 0;
+		}
+		// walk down at most k nodes; if top is unchanged at the
+		// CAS, so is everything we read below it
+		newTop = topCopy.ptr();
+		for(n=0; n<k && newTop!=NULL; n++){
+			out[n] = newTop->val;
+			newTop = newTop->down;
+		}
+		if(top.CAS(topCopy,newTop)){// swing top past the batch
+			// the detached nodes are ours now
+			Node* cur = topCopy.ptr();
+			for(int i=0;i<n;i++){
+				Node* down = cur->down;
+				bp->free(cur,tid);
+				cur = down;
+			}
+			counts[tid].ui.pops+=n;
+			return n;
+		}
+	}
+}
+
 KeyVal TreiberStack::peek(int tid){
 	cptr_local<Node> topCopy;
 	KeyVal kv;
@@ -138,8 +235,8 @@ bool TreiberStack::remove_cond(uint64_t key, int tid){
 
 	newTop = topCopy->down; // get new top
 	if(top.CAS(topCopy,newTop)){// swing top
-		int32_t val = topCopy->val;
 		bp->free(topCopy.ptr(),tid);
+		counts[tid].ui.pops++;
 		return true; // finished if succeed
 	}
 	return false;
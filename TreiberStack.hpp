@@ -38,9 +38,16 @@ class TreiberStack : public virtual RPeekableContainer, public virtual RStack, p
 		public:
 		Node* down;
 		int32_t val;
+		#ifdef TSTACK_SIZE_TRACKING
 		int64_t size;
+		#endif
 		//uint8_t pad1[CACHE_LINE_SIZE-(sizeof(cptr<Node>)-sizeof(int32_t))]; //pad
-		void init(int32_t v, int32_t sz, Node* d){size = sz; down=d;val=v;}
+		void init(int32_t v, int32_t sz, Node* d){
+			#ifdef TSTACK_SIZE_TRACKING
+			size = sz;
+			#endif
+			down=d;val=v;
+		}
 	};//__attribute__(( aligned(CACHE_LINE_SIZE) ));
 
 	cptr<Node> top
@@ -48,7 +55,17 @@ class TreiberStack : public virtual RPeekableContainer, public virtual RStack, p
 
 	BlockPool<Node>* bp;
 	int task_num;
+	#ifdef TSTACK_SIZE_TRACKING
+	// diagnostic: every push reads the old top's size and
+	// raises this shared maximum, so it costs a miss and a CAS
 	std::atomic<int> maxSize;
+	#endif
+	// per thread successful pushes and pops, for the size
+	struct OpCounts{
+		int64_t pushes;
+		int64_t pops;
+	};
+	padded<OpCounts>* counts;
 	Node* dummy; // for valgrind stupidity (it seems to be confused by cptr's)
 
 	public:
@@ -63,6 +80,15 @@ class TreiberStack : public virtual RPeekableContainer, public virtual RStack, p
 	KeyVal peek(int tid);
 	bool remove_cond(uint64_t key, int tid);
 
+	// Pushes vals[0..k-1] as one chain with a single CAS on top,
+	// so vals[k-1] ends up on top, as if pushed in order.
+	void push_batch(int32_t* vals, int k, int tid);
+	// Detaches up to k nodes with a single CAS on top, writing
+	// their values top first into out; returns how many, 0 if
+	// empty.  Both move top like k single operations would, so
+	// peek and remove_cond see the chain one node at a time.
+	int pop_batch(int32_t* out, int k, int tid);
+
 };
 
 class TreiberStackFactory : public RContainerFactory{
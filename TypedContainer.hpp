@@ -0,0 +1,201 @@
+/*
+
+Copyright 2015 University of Rochester
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+
+
+
+
+
+#ifndef TYPED_CONTAINER_HPP
+#define TYPED_CONTAINER_HPP
+
+#ifndef _REENTRANT
+#define _REENTRANT		/* basic 3-lines for threads */
+#endif
+
+#include <stdint.h>
+#include <atomic>
+#include "ConcurrentPrimitives.hpp"
+#include "RContainer.hpp"
+#include "RDualContainer.hpp"
+
+
+// Values wider than int32_t, pointers and 64 bit handles, passed
+// through the existing int32_t containers by slot indirection:
+// insert() parks the value in a slot of a ValueSlots table and
+// passes the slot's number, remove() reads the value back and
+// frees the slot.  Any container, dual or total, can carry them
+// unchanged, at the price of one extra line touched per item.
+
+// Fixed size table of T with a free list of slot numbers.  Each
+// thread allocates from and frees into its own cache, so a slot
+// freed by the consumer is simply reused by the consumer's next
+// insert.  Caches trade surplus and shortage with a shared
+// Treiber stack of BATCH-slot chains, linked through link[] and
+// named by their first slot, with a tag against ABA.
+template <class T>
+class ValueSlots{
+	static const int BATCH = 64;
+
+	struct Cache{
+		int32_t free[2*BATCH];
+		int n;
+	};
+
+	T* vals;
+	int32_t* link; // next slot in a chain
+	int32_t* chainNext; // next chain on the stack, by first slot
+	std::atomic<uint64_t> chains; // tag<<32 | first slot+1, or 0 if empty
+	char pad1[LEVEL1_DCACHE_LINESIZE-sizeof(std::atomic<uint64_t>)];
+	padded<Cache>* caches;
+	int capacity;
+
+	void pushChain(int32_t* s){
+		for(int i = 0; i<BATCH-1; i++){
+			link[s[i]] = s[i+1];
+		}
+		uint64_t old = chains.load(std::memory_order_acquire);
+		uint64_t nw;
+		do{
+			chainNext[s[0]] = (int32_t)(old&0xffffffff)-1;
+			nw = ((old>>32)+1)<<32 | (uint32_t)(s[0]+1);
+		}while(!chains.compare_exchange_weak(old,nw,std::memory_order_acq_rel));
+	}
+
+	// false if the stack is empty
+	bool popChain(int32_t* s){
+		uint64_t old = chains.load(std::memory_order_acquire);
+		uint64_t nw;
+		int32_t first;
+		do{
+			if((old&0xffffffff)==0){return false;}
+			first = (int32_t)(old&0xffffffff)-1;
+			// a stale read is caught by the tag
+			nw = ((old>>32)+1)<<32 | (uint32_t)(chainNext[first]+1);
+		}while(!chains.compare_exchange_weak(old,nw,std::memory_order_acq_rel));
+		s[0] = first;
+		for(int i = 1; i<BATCH; i++){
+			s[i] = link[s[i-1]];
+		}
+		return true;
+	}
+
+public:
+	// capacity is rounded up to a whole number of chains
+	ValueSlots(int task_num, int capacity){
+		this->capacity = (capacity+BATCH-1)/BATCH*BATCH;
+		vals = new T[this->capacity];
+		link = new int32_t[this->capacity];
+		chainNext = new int32_t[this->capacity];
+		caches = new padded<Cache>[task_num];
+		for(int i = 0; i<task_num; i++){
+			caches[i].ui.n = 0;
+		}
+		chains.store(0);
+		int32_t s[BATCH];
+		for(int c = this->capacity-BATCH; c>=0; c-=BATCH){
+			for(int i = 0; i<BATCH; i++){
+				s[i] = c+i;
+			}
+			pushChain(s);
+		}
+	}
+	~ValueSlots(){
+		delete[] vals;
+		delete[] link;
+		delete[] chainNext;
+		delete[] caches;
+	}
+
+	// a slot number in [0,capacity) holding v
+	int32_t put(T v, int tid){
+		Cache& c = caches[tid].ui;
+		if(c.n==0){
+			if(!popChain(c.free)){
+				errexit("ValueSlots full; raise its capacity.");
+			}
+			c.n = BATCH;
+		}
+		int32_t s = c.free[--c.n];
+		vals[s] = v;
+		return s;
+	}
+
+	// the value in slot s, freeing the slot
+	T take(int32_t s, int tid){
+		T v = vals[s];
+		Cache& c = caches[tid].ui;
+		c.free[c.n++] = s;
+		if(c.n==2*BATCH){
+			pushChain(c.free+BATCH);
+			c.n = BATCH;
+		}
+		return v;
+	}
+
+	int size(){return capacity;}
+};
+
+
+// A container of T, in the shape of RContainer.  remove()
+// returns false where an int32_t container returns EMPTY.
+template <class T>
+class RTypedContainer : public virtual Rideable{
+public:
+	virtual bool remove(T* val,int tid)=0;
+	virtual void insert(T val,int tid)=0;
+};
+
+// Carries T through any RContainer as ValueSlots slot numbers,
+// offset by one since 0 is EMPTY.  A dual container still
+// blocks in remove() until a value arrives.
+template <class T>
+class SlotContainer : public virtual RTypedContainer<T>, public Reportable{
+	RContainer* inner;
+	ValueSlots<T>* slots;
+
+public:
+	SlotContainer(RContainer* inner, int task_num, int capacity){
+		this->inner = inner;
+		slots = new ValueSlots<T>(task_num,capacity);
+	}
+	~SlotContainer(){
+		delete slots;
+	}
+
+	void insert(T val,int tid){
+		inner->insert(slots->put(val,tid)+1,tid);
+	}
+	bool remove(T* val,int tid){
+		int32_t s = inner->remove(tid);
+		if(s==EMPTY){return false;}
+		*val = slots->take(s-1,tid);
+		return true;
+	}
+
+	RContainer* container(){return inner;}
+
+	void conclude(){
+		Reportable* r = dynamic_cast<Reportable*>(inner);
+		if(r!=NULL){
+			r->conclude();
+		}
+	}
+};
+
+#endif
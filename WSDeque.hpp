@@ -0,0 +1,120 @@
+/*
+
+Copyright 2015 University of Rochester
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+
+
+#ifndef WSDEQUE_HPP
+#define WSDEQUE_HPP
+
+#ifndef _REENTRANT
+#define _REENTRANT		/* basic 3-lines for threads */
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include "ConcurrentPrimitives.hpp"
+
+
+// Work stealing deque of pointers
+// "Dynamic Circular Work-Stealing Deque"
+// David Chase and Yossi Lev
+// 2005
+// using the C11 orderings of
+// "Correct and Efficient Work-Stealing for Weak Memory Models"
+// Le, Pop, Cohen and Zappa Nardelli
+// 2013
+//
+// The owner pushes and pops at the bottom, thieves steal from
+// the top.  The buffer does not grow; push fails when it is
+// full and the caller must put the item elsewhere.
+
+template<class T>
+class WSDeque{
+	std::atomic<int64_t> top;
+	char pad1[LEVEL1_DCACHE_LINESIZE-sizeof(std::atomic<int64_t>)];
+	std::atomic<int64_t> bottom;
+	char pad2[LEVEL1_DCACHE_LINESIZE-sizeof(std::atomic<int64_t>)];
+	std::atomic<T*>* buf;
+	int64_t mask;
+
+public:
+	// size must be a power of two
+	WSDeque(int size=4096){
+		mask = size-1;
+		buf = new std::atomic<T*>[size];
+		top.store(0);
+		bottom.store(0);
+	}
+	~WSDeque(){delete[] buf;}
+
+	// owner only
+	bool push(T* x){
+		int64_t b = bottom.load(std::memory_order_relaxed);
+		int64_t t = top.load(std::memory_order_acquire);
+		if(b-t>mask){
+			return false;
+		}
+		buf[b&mask].store(x,std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		bottom.store(b+1,std::memory_order_relaxed);
+		return true;
+	}
+
+	// owner only, NULL if empty
+	T* pop(){
+		int64_t b = bottom.load(std::memory_order_relaxed)-1;
+		bottom.store(b,std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t t = top.load(std::memory_order_relaxed);
+		T* x = NULL;
+		if(t<=b){
+			x = buf[b&mask].load(std::memory_order_relaxed);
+			if(t==b){
+				// last item, race the thieves for it
+				if(!top.compare_exchange_strong(t,t+1,
+				  std::memory_order_seq_cst,std::memory_order_relaxed)){
+					x = NULL;
+				}
+				bottom.store(b+1,std::memory_order_relaxed);
+			}
+		}
+		else{
+			bottom.store(b+1,std::memory_order_relaxed);
+		}
+		return x;
+	}
+
+	// any thread, NULL if empty or lost a race
+	T* steal(){
+		int64_t t = top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t b = bottom.load(std::memory_order_acquire);
+		if(t<b){
+			T* x = buf[t&mask].load(std::memory_order_relaxed);
+			if(!top.compare_exchange_strong(t,t+1,
+			  std::memory_order_seq_cst,std::memory_order_relaxed)){
+				return NULL;
+			}
+			return x;
+		}
+		return NULL;
+	}
+};
+
+#endif